@@ -37,90 +37,183 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "llz.h"
+#include "llz_internal.h"
 #include "swap_bytes.h"
 #include "llz_version.h"
 
+#ifndef NVWIN3X
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-typedef struct
-{
-  FILE          *fp;
-  uint8_t       time_flag;            /*!<  This is duplicated in header due to the need to support 1.0 files.  */
-  uint8_t       uncertainty_flag;     /*!<  This is duplicated in header due to the need to support 1.0 files.  */
-  uint8_t     depth_units;          /*!<  This is duplicated in header due to the need to support 1.0 files.  */
-  uint8_t       swap;
-  uint8_t       at_end;
-  uint8_t       size_changed;
-  uint8_t       modified;
-  uint8_t       created;
-  uint8_t       write;
-  LLZ_HEADER    header;
-  uint16_t      major_version;
-} INTERNAL_LLZ_HEADER;
 
-typedef struct
-{
-  int32_t      tv_sec;
-  int32_t      tv_nsec;
-  int32_t      uncertainty;
-  int32_t      lat;
-  int32_t      lon;
-  int32_t      dep;
-  uint16_t    stat;
-} INTERNAL_LLZ;
+/*  The handle pool.  Handle structures are allocated as they're needed and are never freed or moved so looking up
+    a handle is just an array index and growing the pool doesn't disturb handles that other threads are using.  */
+
+static INTERNAL_LLZ_HEADER *llzh[LLZ_MAX_HANDLES];
+static int32_t llzh_count = 0;
+
+
+/*  Handle allocation and release are serialized with this mutex.  Everything else in INTERNAL_LLZ_HEADER belongs
+    to the thread that is using that handle, so different handles can be used concurrently by different threads.  */
+
+static pthread_mutex_t llz_handle_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-static INTERNAL_LLZ_HEADER llzh[MAX_LLZ_FILES];
-static uint8_t first;
-static int32_t llz_recnum[MAX_LLZ_FILES];
+
+#ifdef NVWIN3X
+
+/*  There's no pread or pwrite on Windows so positional reads and writes fall back to seek/read (or seek/write) under
+    this mutex.  */
+
+static pthread_mutex_t llz_pread_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#endif
 
 
 int32_t big_endian ();
 
 
+/*  Maximum number of records staged in the bulk I/O buffer at one time.  */
+
+#define LLZ_CHUNK_RECORDS 16384
+
+
+/*  Size, in bytes, of the read ahead buffer used by read_llz when it's called for consecutive records.  */
+
+#define LLZ_READ_AHEAD_BYTES 65536
+
+
 
 /********************************************************************/
 /*!
 
- - Function:    swap_internal_llz
+ - Function:    allocate_llz_handle
 
- - Purpose:     Byte swap an internal llz record.
+ - Purpose:     Atomically find and claim an unused llz handle.
 
- - Author:      Jan C. Depner (area.based.editor@gmail.com)
+ - Date:        10/16/26
 
- - Date:        08/31/06
+ - Arguments:   N/A
 
- - Arguments:   data           -    The internal format llz record to be swapped
+ - Returns:
+                - The file handle or -1 if there are too many open files
 
- - Returns:     N/A
+********************************************************************/
+
+static int32_t allocate_llz_handle ()
+{
+  int32_t i, hnd = -1;
+
+
+  pthread_mutex_lock (&llz_handle_mutex);
+
+
+  /*  Reuse the lowest numbered free handle so that programs that open a few files at a time get the same handle
+      numbers that they always have.  */
+
+  for (i = 0 ; i < llzh_count ; i++)
+    {
+      if (!llzh[i]->in_use)
+        {
+          hnd = i;
+          break;
+        }
+    }
+
+
+  /*  If they're all in use, grow the pool.  */
+
+  if (hnd < 0 && llzh_count < LLZ_MAX_HANDLES)
+    {
+      if ((llzh[llzh_count] = (INTERNAL_LLZ_HEADER *) calloc (1, sizeof (INTERNAL_LLZ_HEADER))) != NULL)
+        {
+          hnd = llzh_count;
+          llzh_count++;
+        }
+    }
+
+  if (hnd >= 0)
+    {
+      llzh[hnd]->in_use = 1;
+      llzh[hnd]->recnum = 0;
+    }
+
+  pthread_mutex_unlock (&llz_handle_mutex);
+
+  return (hnd);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    check_llz_handle
+
+ - Purpose:     Make sure that hnd refers to an open llz file.  The
+                handle's owner is the only thread that can close it so
+                we don't need the mutex here.
+
+ - Date:        10/16/26
+
+ - Arguments:   hnd            =    The llz file handle
+
+ - Returns:
+                - 0 if the handle is invalid
+                - 1
 
 ********************************************************************/
 
-static void swap_internal_llz (INTERNAL_LLZ *data)
+static uint8_t check_llz_handle (int32_t hnd)
 {
-  swap_int (&data->tv_sec);
-  swap_int (&data->tv_nsec);
-  swap_int (&data->uncertainty);
-  swap_int (&data->lat);
-  swap_int (&data->lon);
-  swap_int (&data->dep);
-  swap_int ((int32_t *) &data->stat);
+  if (hnd < 0 || hnd >= LLZ_MAX_HANDLES || llzh[hnd] == NULL || !llzh[hnd]->in_use || llzh[hnd]->fp == NULL) return (0);
+
+  return (1);
 }
 
 
 /********************************************************************/
 /*!
 
- - Function:    write_llz_header
+ - Function:    get_llz_handle
 
- - Purpose:     Write the llz_header to the llz file.
+ - Purpose:     Give the other llz library source files access to the
+                internal state of an open handle.
 
- - Author:      Jan C. Depner (area.based.editor@gmail.com)
+ - Date:        10/16/26
 
- - Date:        08/31/06
+ - Arguments:   hnd            =    The llz file handle
+
+ - Returns:
+                - The internal header or NULL if the handle is invalid
+
+********************************************************************/
+
+INTERNAL_LLZ_HEADER *get_llz_handle (int32_t hnd)
+{
+  if (!check_llz_handle (hnd)) return (NULL);
+
+  return (llzh[hnd]);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    release_llz_handle
+
+ - Purpose:     Free anything hanging off of an llz handle, clear it, and
+                return it to the pool.  The file must already be closed.
+
+ - Date:        10/16/26
 
  - Arguments:   hnd            =    The llz file handle
 
@@ -128,164 +221,381 @@ static void swap_internal_llz (INTERNAL_LLZ *data)
 
 ********************************************************************/
 
-static void write_llz_header (int32_t hnd)
+static void release_llz_handle (int32_t hnd)
 {
-  uint8_t zero = 0;
-  int32_t i, size ;
-  char token[1024], version[1024];
+  if (llzh[hnd]->buffer) free (llzh[hnd]->buffer);
+  if (llzh[hnd]->raw_buffer) free (llzh[hnd]->raw_buffer);
+  if (llzh[hnd]->path) free (llzh[hnd]->path);
+  if (llzh[hnd]->index) free_llz_index (llzh[hnd]->index);
+  if (llzh[hnd]->compression) free_llz_compression (llzh[hnd]->compression);
+  if (llzh[hnd]->ahead) free (llzh[hnd]->ahead);
 
-  rewind (llzh[hnd].fp);
 
+  pthread_mutex_lock (&llz_handle_mutex);
 
-  fprintf (llzh[hnd].fp, "[VERSION] = %s\n", LLZ_VERSION);
+  memset (llzh[hnd], 0, sizeof (INTERNAL_LLZ_HEADER));
+  llzh[hnd]->fp = NULL;
 
+  pthread_mutex_unlock (&llz_handle_mutex);
+}
 
-  /* Added version check before the creation of llz files */
-  /* In the past, created llz files were defaulted to version 0 (32bit status) */
 
-  strcpy(version, LLZ_VERSION);
-  strcpy(token, strtok(version, "V"));
-  strcpy(token, strtok(NULL, version));
-  strcpy(token, strtok(token, " "));
-  llzh[hnd].major_version = (uint16_t) atoi(token);
+/********************************************************************/
+/*!
+
+ - Function:    sync_llz_record_count
+
+ - Purpose:     Set the 32 bit number_of_records in the header from the
+                64 bit record count.  Files with more than INT32_MAX
+                records report INT32_MAX in the 32 bit field.
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:     N/A
 
+********************************************************************/
 
-  if (llzh[hnd].time_flag)
+void sync_llz_record_count (INTERNAL_LLZ_HEADER *llz)
+{
+  if (llz->number_of_records64 > INT32_MAX)
     {
-      fprintf (llzh[hnd].fp, "[TIME FLAG] = 1\n");
+      llz->header.number_of_records = INT32_MAX;
     }
   else
     {
-      fprintf (llzh[hnd].fp, "[TIME FLAG] = 0\n");
+      llz->header.number_of_records = (int32_t) llz->number_of_records64;
     }
+}
 
-  if (llzh[hnd].uncertainty_flag)
-    {
-      fprintf (llzh[hnd].fp, "[UNCERTAINTY FLAG] = 1\n");
-    }
-  else
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_major_version
+
+ - Purpose:     Get the major version number from an llz version
+                string (e.g. 4 from "PFM Software - llz library V4.03
+                - 07/21/2014").  Unlike strtok this is reentrant.
+
+ - Date:        10/16/26
+
+ - Arguments:   version        =    The version string
+
+ - Returns:     The major version or 0 if it can't be found
+
+********************************************************************/
+
+static uint16_t get_llz_major_version (const char *version)
+{
+  const char *ptr;
+
+
+  if ((ptr = strstr (version, "llz library V")) == NULL) return (0);
+
+  return ((uint16_t) atoi (ptr + strlen ("llz library V")));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_time_string
+
+ - Purpose:     Reentrant replacement for asctime (localtime ()) without
+                the trailing new line.
+
+ - Date:        10/16/26
+
+ - Arguments:   time_date      =    The returned time string (at least 32 characters)
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void get_llz_time_string (char *time_date)
+{
+  static const char day[7][4] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+  static const char month[12][4] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+  time_t systemtime;
+  struct tm tm;
+
+
+  systemtime = time (NULL);
+
+#ifdef NVWIN3X
+  localtime_s (&tm, &systemtime);
+#else
+  localtime_r (&systemtime, &tm);
+#endif
+
+  sprintf (time_date, "%.3s %.3s%3d %.2d:%.2d:%.2d %d", day[tm.tm_wday], month[tm.tm_mon], tm.tm_mday, tm.tm_hour, tm.tm_min,
+           tm.tm_sec, 1900 + tm.tm_year);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    set_llz_layout
+
+ - Purpose:     Compute the on-disk byte layout of a record based on
+                the major version and the time/uncertainty flags.
+                This mirrors the three file layouts that read_llz has
+                always supported:
+                    - Version 1.00 : lat, lon, depth, 32 bit status
+                    - Version 2.xx/3.xx : [time], [uncertainty (3.xx only)],
+                      lat, lon, depth, 32 bit status
+                    - Version 4.00 and later : [time], [uncertainty], lat,
+                      lon, depth, 16 bit status
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void set_llz_layout (INTERNAL_LLZ_HEADER *llz)
+{
+  int32_t offset = 0;
+  LLZ_LAYOUT *layout = &llz->layout;
+
+
+  layout->time_offset = -1;
+  layout->uncertainty_offset = -1;
+
+
+  /*  Version 1.00 files never have time or uncertainty.  */
+
+  if (llz->major_version >= 2 && llz->time_flag)
     {
-      fprintf (llzh[hnd].fp, "[UNCERTAINTY FLAG] = 0\n");
+      layout->time_offset = offset;
+      offset += 2 * sizeof (int32_t);
     }
 
-  switch (llzh[hnd].depth_units)
+
+  /*  Uncertainty was added in version 3.00.  */
+
+  if (llz->major_version >= 3 && llz->uncertainty_flag)
     {
-    case 0:
-    default:
-      fprintf (llzh[hnd].fp, "[DEPTH UNITS] = METERS\n");
-      break;
-
-    case 1:
-      fprintf (llzh[hnd].fp, "[DEPTH UNITS] = FEET\n");
-      break;
-
-    case 2:
-      fprintf (llzh[hnd].fp, "[DEPTH UNITS] = FATHOMS\n");
-      break;
-
-    case 3:
-      fprintf (llzh[hnd].fp, "[DEPTH UNITS] = CUBITS\n");
-      break;
-
-    case 4:
-      fprintf (llzh[hnd].fp, "[DEPTH UNITS] = WILLETTS\n");
-      break;
+      layout->uncertainty_offset = offset;
+      offset += sizeof (int32_t);
     }
 
+  layout->lat_offset = offset;
+  offset += 3 * sizeof (int32_t);
+
+  layout->stat_offset = offset;
 
-  if (big_endian ())
+
+  /*  Version 4.00 and later use a 16 bit status.  */
+
+  if (llz->major_version >= 4)
     {
-      fprintf (llzh[hnd].fp, "[ENDIAN] = BIG\n");
+      layout->stat_size = sizeof (uint16_t);
     }
   else
     {
-      fprintf (llzh[hnd].fp, "[ENDIAN] = LITTLE\n");
+      layout->stat_size = sizeof (uint32_t);
     }
 
-  fprintf (llzh[hnd].fp, "[CLASSIFICATION] = %s\n", llzh[hnd].header.classification);
-  fprintf (llzh[hnd].fp, "[DISTRIBUTION] = %s\n", llzh[hnd].header.distribution);
-  fprintf (llzh[hnd].fp, "[DECLASSIFICATION] = %s\n", llzh[hnd].header.declassification);
-  fprintf (llzh[hnd].fp, "[CLASSIFICATION JUSTIFICATION] = %s\n", llzh[hnd].header.class_just);
-  fprintf (llzh[hnd].fp, "[DOWNGRADE] = %s\n", llzh[hnd].header.downgrade);
-  fprintf (llzh[hnd].fp, "[SOURCE] = %s\n", llzh[hnd].header.source);
-  fprintf (llzh[hnd].fp, "[COMMENTS] = %s\n", llzh[hnd].header.comments);
-  fprintf (llzh[hnd].fp, "[CREATION DATE] = %s\n", llzh[hnd].header.creation_date);
-  fprintf (llzh[hnd].fp, "[LAST MODIFIED DATE] = %s\n", llzh[hnd].header.modified_date);
+  layout->record_size = offset + layout->stat_size;
+}
+
 
-  fprintf (llzh[hnd].fp, "[NUMBER OF RECORDS] = %d\n", llzh[hnd].header.number_of_records);
+/********************************************************************/
+/*!
 
+ - Function:    get_llz_buffer
 
-  fprintf (llzh[hnd].fp, "[END OF HEADER]\n");
+ - Purpose:     Make sure the handle's staging buffer can hold at least
+                size bytes.
 
+ - Date:        10/16/26
 
-  size = LLZ_HEADER_SIZE - ftell (llzh[hnd].fp);
+ - Arguments:
+                - hnd            =    The llz file handle
+                - size           =    Required size in bytes
 
-  for (i = 0 ; i < size ; i++) fwrite (&zero, 1, 1, llzh[hnd].fp);
-}
+ - Returns:
+                - Pointer to the buffer or NULL on allocation failure
+
+********************************************************************/
+
+static uint8_t *get_llz_buffer (int32_t hnd, size_t size)
+{
+  uint8_t *new_buffer;
+
+
+  if (size > llzh[hnd]->buffer_size)
+    {
+      if ((new_buffer = (uint8_t *) realloc (llzh[hnd]->buffer, size)) == NULL) return (NULL);
 
+      llzh[hnd]->buffer = new_buffer;
+      llzh[hnd]->buffer_size = size;
+    }
+
+  return (llzh[hnd]->buffer);
+}
 
 
 /********************************************************************/
 /*!
 
- - Function:    create_llz
+ - Function:    write_llz_header
 
- - Purpose:     Create an llz file.
+ - Purpose:     Write the llz_header to the llz file.
 
  - Author:      Jan C. Depner (area.based.editor@gmail.com)
 
  - Date:        08/31/06
 
- - Arguments:
-                - path           =    The llz file path
-                - llz_header     =    LLZ_HEADER structure to
-                                      be written to the file
-                                      Note: leave version, number_of_records,
-                                      creation_date, and modified_date
-                                      empty.  Don't forget to set time_flag,
-                                      uncertainty_flag, and depth_units.
+ - Arguments:   hnd            =    The llz file handle
 
- - Returns:
-                - The file handle or -1 on error
+ - Returns:     N/A
 
 ********************************************************************/
 
-int32_t create_llz (const char *path, LLZ_HEADER llz_header)
+static void write_llz_header (int32_t hnd)
 {
-  int32_t i, hnd;
+  static const char *units[5] = {"METERS", "FEET", "FATHOMS", "CUBITS", "WILLETTS"};
+  char text[LLZ_HEADER_SIZE];
+  size_t length;
+  LLZ_HEADER *header = &llzh[hnd]->header;
 
 
-  /*  The first time through we want to initialize the llz handle array.  */
+  /* Added version check before the creation of llz files */
+  /* In the past, created llz files were defaulted to version 0 (32bit status) */
 
-  if (first)
+  llzh[hnd]->major_version = get_llz_major_version (LLZ_VERSION);
+
+
+  /*  Build the whole header block (zero padded to LLZ_HEADER_SIZE) in memory and write it with a single call.
+      The fixed size LLZ_HEADER strings can't add up to anywhere near LLZ_HEADER_SIZE so this never truncates.  */
+
+  memset (text, 0, LLZ_HEADER_SIZE);
+
+  snprintf (text, LLZ_HEADER_SIZE,
+            "[VERSION] = %s\n"
+            "[TIME FLAG] = %d\n"
+            "[UNCERTAINTY FLAG] = %d\n"
+            "[DEPTH UNITS] = %s\n"
+            "[ENDIAN] = %s\n"
+            "[CLASSIFICATION] = %s\n"
+            "[DISTRIBUTION] = %s\n"
+            "[DECLASSIFICATION] = %s\n"
+            "[CLASSIFICATION JUSTIFICATION] = %s\n"
+            "[DOWNGRADE] = %s\n"
+            "[SOURCE] = %s\n"
+            "[COMMENTS] = %s\n"
+            "[CREATION DATE] = %s\n"
+            "[LAST MODIFIED DATE] = %s\n"
+            "[NUMBER OF RECORDS] = %" PRId64 "\n",
+            LLZ_VERSION,
+            llzh[hnd]->time_flag ? 1 : 0,
+            llzh[hnd]->uncertainty_flag ? 1 : 0,
+            units[llzh[hnd]->depth_units <= LLZ_WILLETTS ? llzh[hnd]->depth_units : LLZ_METERS],
+            big_endian () ? "BIG" : "LITTLE",
+            header->classification,
+            header->distribution,
+            header->declassification,
+            header->class_just,
+            header->downgrade,
+            header->source,
+            header->comments,
+            header->creation_date,
+            header->modified_date,
+            llzh[hnd]->compressed ? (int64_t) 0 : llzh[hnd]->number_of_records64);
+
+
+  /*  Compressed files say they have no records in [NUMBER OF RECORDS] so that older versions of the library
+      (which don't know about [COMPRESSION]) see an empty file instead of garbage.  */
+
+  if (llzh[hnd]->compressed)
     {
-      for (i = 0 ; i < MAX_LLZ_FILES ; i++) 
-        {
-          memset (&llzh[i], 0, sizeof (INTERNAL_LLZ_HEADER));
-          llzh[i].fp = NULL;
-        }
-      first = 0;
+      length = strlen (text);
+      snprintf (text + length, LLZ_HEADER_SIZE - length,
+                "[COMPRESSION] = %s\n"
+                "[BLOCK RECORDS] = %d\n"
+                "[BLOCK TABLE] = %" PRId64 "\n"
+                "[COMPRESSED RECORDS] = %" PRId64 "\n",
+                llzh[hnd]->compressed == LLZ_COMPRESSION_PACKED ? "PACKED" : "DELTA",
+                llzh[hnd]->block_records,
+                llzh[hnd]->block_table,
+                llzh[hnd]->number_of_records64);
     }
 
 
-  /*  Find the next available handle and make sure we haven't opened too many.  */
 
-  hnd = MAX_LLZ_FILES;
-  for (i = 0 ; i < MAX_LLZ_FILES ; i++)
+  /*  Statistics of the valid records (see llz_stats.c).  These are left out if we don't know them.  */
+
+  if (llzh[hnd]->stats_state == LLZ_STATS_CURRENT)
     {
-      if (llzh[i].fp == NULL)
-        {
-          hnd = i;
-          llz_recnum[hnd] = 0;
-          break;
-        }
+      length = strlen (text);
+      snprintf (text + length, LLZ_HEADER_SIZE - length,
+                "[VALID COUNT] = %" PRId64 "\n"
+                "[MIN LAT] = %.7f\n"
+                "[MAX LAT] = %.7f\n"
+                "[MIN LON] = %.7f\n"
+                "[MAX LON] = %.7f\n"
+                "[MIN DEPTH] = %.4f\n"
+                "[MAX DEPTH] = %.4f\n",
+                llzh[hnd]->stats.valid_count,
+                (double) llzh[hnd]->stats.min_lat / 10000000.0,
+                (double) llzh[hnd]->stats.max_lat / 10000000.0,
+                (double) llzh[hnd]->stats.min_lon / 10000000.0,
+                (double) llzh[hnd]->stats.max_lon / 10000000.0,
+                (double) llzh[hnd]->stats.min_depth / 10000.0,
+                (double) llzh[hnd]->stats.max_depth / 10000.0);
     }
 
+  length = strlen (text);
+  snprintf (text + length, LLZ_HEADER_SIZE - length, "[END OF HEADER]\n");
+
+
+  rewind (llzh[hnd]->fp);
+
+  fwrite (text, LLZ_HEADER_SIZE, 1, llzh[hnd]->fp);
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    create_llz_file
+
+ - Purpose:     Create an llz file.  This does all of the work for
+                create_llz and create_llz_compressed.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - path           =    The llz file path
+                - llz_header     =    LLZ_HEADER structure to
+                                      be written to the file
+                - compressed     =    If set, create a block compressed
+                                      file
+
+ - Returns:
+                - The file handle or -1 on error
+
+********************************************************************/
+
+static int32_t create_llz_file (const char *path, LLZ_HEADER llz_header, uint8_t compressed)
+{
+  int32_t hnd;
+
 
-  if (hnd == MAX_LLZ_FILES)
+  /*  Find the next available handle and make sure we haven't opened too many.  */
+
+  if ((hnd = allocate_llz_handle ()) < 0)
     {
-      fprintf (stderr, "\n\nToo many open llz files!\nTerminating!\n\n");
-      exit (-1);
+      fprintf (stderr, "\n\nToo many open llz files!\n\n");
+      return (-1);
     }
 
 
@@ -297,31 +607,59 @@ int32_t create_llz (const char *path, LLZ_HEADER llz_header)
   if (llz_header.depth_units > 4) llz_header.depth_units = 0;
 
 
-  llzh[hnd].time_flag = llz_header.time_flag;
-  llzh[hnd].uncertainty_flag = llz_header.uncertainty_flag;
-  llzh[hnd].depth_units = llz_header.depth_units;
+  llzh[hnd]->time_flag = llz_header.time_flag;
+  llzh[hnd]->uncertainty_flag = llz_header.uncertainty_flag;
+  llzh[hnd]->depth_units = llz_header.depth_units;
+
+  if (compressed)
+    {
+      llzh[hnd]->compressed = LLZ_COMPRESSION_PACKED;
+      llzh[hnd]->block_records = LLZ_COMPRESS_BLOCK_RECORDS;
+    }
+
+
+  /*  A new file has no valid records so its statistics are known from the start.  */
+
+  llzh[hnd]->stats_state = LLZ_STATS_CURRENT;
 
 
   /*  Open the file and write the header.  */
 
-  if ((llzh[hnd].fp = fopen64 (path, "wb+")) != NULL)
+  if ((llzh[hnd]->fp = fopen64 (path, "wb+")) != NULL)
     {
-      llzh[hnd].header = llz_header;
+      llzh[hnd]->header = llz_header;
+      llzh[hnd]->number_of_records64 = 0;
+      sync_llz_record_count (llzh[hnd]);
 
       write_llz_header (hnd);
+
+      set_llz_layout (llzh[hnd]);
+
+
+      /*  Save the path so that we can find the index sidecar file.  */
+
+      if ((llzh[hnd]->path = (char *) malloc (strlen (path) + 1)) != NULL) strcpy (llzh[hnd]->path, path);
+
+      if (compressed && !start_llz_compression (llzh[hnd]))
+        {
+          fclose (llzh[hnd]->fp);
+          remove (path);
+          release_llz_handle (hnd);
+          return (-1);
+        }
     }
   else
     {
-      hnd = -1;
+      release_llz_handle (hnd);
+      return (-1);
     }
 
 
-  llzh[hnd].at_end = 1;
-  llzh[hnd].size_changed = 1;
-  llzh[hnd].modified = 1;
-  llzh[hnd].created = 1;
-  llzh[hnd].write = 1;
-  llzh[hnd].header.number_of_records = 0;
+  llzh[hnd]->at_end = 1;
+  llzh[hnd]->size_changed = 1;
+  llzh[hnd]->modified = 1;
+  llzh[hnd]->created = 1;
+  llzh[hnd]->write = 1;
 
   return (hnd);
 }
@@ -330,9 +668,9 @@ int32_t create_llz (const char *path, LLZ_HEADER llz_header)
 /********************************************************************/
 /*!
 
- - Function:    open_llz
+ - Function:    create_llz
 
- - Purpose:     Open an llz file.
+ - Purpose:     Create an llz file.
 
  - Author:      Jan C. Depner (area.based.editor@gmail.com)
 
@@ -340,676 +678,2300 @@ int32_t create_llz (const char *path, LLZ_HEADER llz_header)
 
  - Arguments:
                 - path           =    The llz file path
-                - llz_header     =    LLZ_HEADER structure to be populated
+                - llz_header     =    LLZ_HEADER structure to
+                                      be written to the file
+                                      Note: leave version, number_of_records,
+                                      creation_date, and modified_date
+                                      empty.  Don't forget to set time_flag,
+                                      uncertainty_flag, and depth_units.
 
  - Returns:
                 - The file handle or -1 on error
 
 ********************************************************************/
 
-int32_t open_llz (const char *path, LLZ_HEADER *llz_header)
+int32_t create_llz (const char *path, LLZ_HEADER llz_header)
+{
+  return (create_llz_file (path, llz_header, 0));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    create_llz_compressed
+
+ - Purpose:     Create a block compressed llz file.  The records are
+                bit packed in columns in blocks of
+                LLZ_COMPRESS_BLOCK_RECORDS records (see llz_compress.c)
+                which usually makes the file 3 to 8 times smaller than
+                an uncompressed file (smooth multibeam swaths compress
+                the most) so scanning it over a disk or network file
+                system that delivers less than about 1 GB per second is
+                faster.  Records can only be
+                added with append_llz or append_llz_batch.  When the file
+                is reopened it is read only but all of the read functions
+                (including random access with read_llz) work as usual.
+                Older versions of the library will see an empty file.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - path           =    The llz file path
+                - llz_header     =    LLZ_HEADER structure to
+                                      be written to the file (see
+                                      create_llz)
+
+ - Returns:
+                - The file handle or -1 on error
+
+********************************************************************/
+
+int32_t create_llz_compressed (const char *path, LLZ_HEADER llz_header)
+{
+  return (create_llz_file (path, llz_header, 1));
+}
+
+
+/*  Header keys that parse_llz_header knows about.  */
+
+typedef enum
+{
+  LLZ_KEY_VERSION,
+  LLZ_KEY_TIME_FLAG,
+  LLZ_KEY_UNCERTAINTY_FLAG,
+  LLZ_KEY_DEPTH_UNITS,
+  LLZ_KEY_ENDIAN,
+  LLZ_KEY_CLASSIFICATION,
+  LLZ_KEY_DISTRIBUTION,
+  LLZ_KEY_DECLASSIFICATION,
+  LLZ_KEY_CLASS_JUST,
+  LLZ_KEY_DOWNGRADE,
+  LLZ_KEY_SOURCE,
+  LLZ_KEY_COMMENTS,
+  LLZ_KEY_NUMBER_OF_RECORDS,
+  LLZ_KEY_CREATION_DATE,
+  LLZ_KEY_MODIFIED_DATE,
+  LLZ_KEY_COMPRESSION,
+  LLZ_KEY_BLOCK_RECORDS,
+  LLZ_KEY_BLOCK_TABLE,
+  LLZ_KEY_COMPRESSED_RECORDS,
+  LLZ_KEY_VALID_COUNT,
+  LLZ_KEY_MIN_LAT,
+  LLZ_KEY_MAX_LAT,
+  LLZ_KEY_MIN_LON,
+  LLZ_KEY_MAX_LON,
+  LLZ_KEY_MIN_DEPTH,
+  LLZ_KEY_MAX_DEPTH,
+  LLZ_KEY_END_OF_HEADER
+} LLZ_KEY;
+
+typedef struct
+{
+  const char    *name;
+  size_t        length;
+  LLZ_KEY       key;
+} LLZ_KEY_ENTRY;
+
+#define LLZ_KEY_NAME(name) name, sizeof (name) - 1
+
+static const LLZ_KEY_ENTRY llz_keys[] =
+{
+  {LLZ_KEY_NAME ("VERSION"), LLZ_KEY_VERSION},
+  {LLZ_KEY_NAME ("TIME FLAG"), LLZ_KEY_TIME_FLAG},
+  {LLZ_KEY_NAME ("UNCERTAINTY FLAG"), LLZ_KEY_UNCERTAINTY_FLAG},
+  {LLZ_KEY_NAME ("DEPTH UNITS"), LLZ_KEY_DEPTH_UNITS},
+  {LLZ_KEY_NAME ("ENDIAN"), LLZ_KEY_ENDIAN},
+  {LLZ_KEY_NAME ("CLASSIFICATION"), LLZ_KEY_CLASSIFICATION},
+  {LLZ_KEY_NAME ("DISTRIBUTION"), LLZ_KEY_DISTRIBUTION},
+  {LLZ_KEY_NAME ("DECLASSIFICATION"), LLZ_KEY_DECLASSIFICATION},
+  {LLZ_KEY_NAME ("CLASSIFICATION JUSTIFICATION"), LLZ_KEY_CLASS_JUST},
+  {LLZ_KEY_NAME ("DOWNGRADE"), LLZ_KEY_DOWNGRADE},
+  {LLZ_KEY_NAME ("SOURCE"), LLZ_KEY_SOURCE},
+  {LLZ_KEY_NAME ("COMMENTS"), LLZ_KEY_COMMENTS},
+  {LLZ_KEY_NAME ("NUMBER OF RECORDS"), LLZ_KEY_NUMBER_OF_RECORDS},
+  {LLZ_KEY_NAME ("CREATION DATE"), LLZ_KEY_CREATION_DATE},
+  {LLZ_KEY_NAME ("LAST MODIFIED DATE"), LLZ_KEY_MODIFIED_DATE},
+  {LLZ_KEY_NAME ("COMPRESSION"), LLZ_KEY_COMPRESSION},
+  {LLZ_KEY_NAME ("BLOCK RECORDS"), LLZ_KEY_BLOCK_RECORDS},
+  {LLZ_KEY_NAME ("BLOCK TABLE"), LLZ_KEY_BLOCK_TABLE},
+  {LLZ_KEY_NAME ("COMPRESSED RECORDS"), LLZ_KEY_COMPRESSED_RECORDS},
+  {LLZ_KEY_NAME ("VALID COUNT"), LLZ_KEY_VALID_COUNT},
+  {LLZ_KEY_NAME ("MIN LAT"), LLZ_KEY_MIN_LAT},
+  {LLZ_KEY_NAME ("MAX LAT"), LLZ_KEY_MAX_LAT},
+  {LLZ_KEY_NAME ("MIN LON"), LLZ_KEY_MIN_LON},
+  {LLZ_KEY_NAME ("MAX LON"), LLZ_KEY_MAX_LON},
+  {LLZ_KEY_NAME ("MIN DEPTH"), LLZ_KEY_MIN_DEPTH},
+  {LLZ_KEY_NAME ("MAX DEPTH"), LLZ_KEY_MAX_DEPTH},
+  {LLZ_KEY_NAME ("END OF HEADER"), LLZ_KEY_END_OF_HEADER}
+};
+
+#define LLZ_KEY_COUNT ((int32_t) (sizeof (llz_keys) / sizeof (LLZ_KEY_ENTRY)))
+
+
+/********************************************************************/
+/*!
+
+ - Function:    copy_llz_value
+
+ - Purpose:     Copy a header value that is not NUL terminated into a
+                fixed size string, truncating it if it won't fit.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - dest           =    Destination string
+                - size           =    Size of dest
+                - value          =    Start of the value
+                - length         =    Length of the value
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void copy_llz_value (char *dest, size_t size, const char *value, size_t length)
+{
+  if (length > size - 1) length = size - 1;
+
+  memcpy (dest, value, length);
+  dest[length] = 0;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    parse_llz_depth_units
+
+ - Purpose:     Convert a [DEPTH UNITS] value to the LLZ_HEADER units.
+
+ - Date:        10/16/26
+
+ - Arguments:   info           =    The value (with leading blanks)
+
+ - Returns:     The depth units (defaults to LLZ_METERS)
+
+********************************************************************/
+
+static uint8_t parse_llz_depth_units (const char *info)
 {
-  int32_t i, hnd, tf, uf;
-  char varin[1024], info[1024], token[1024];
+  int32_t units;
+
+
+  while (*info == ' ' || *info == '\t') info++;
+
+  if (*info >= '0' && *info <= '9')
+    {
+      units = atoi (info);
+      if (units < LLZ_METERS || units > LLZ_WILLETTS) units = LLZ_METERS;
+
+      return ((uint8_t) units);
+    }
+
+  if (!strncmp (info, "FEET", 4)) return (LLZ_FEET);
+  if (!strncmp (info, "FATHOMS", 7)) return (LLZ_FATHOMS);
+  if (!strncmp (info, "CUBITS", 6)) return (LLZ_CUBITS);
+  if (!strncmp (info, "WILLETTS", 8)) return (LLZ_WILLETTS);
+
+  return (LLZ_METERS);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    parse_llz_header
+
+ - Purpose:     Parse the ASCII header of an llz file in a single pass.
+                Each line is dispatched on its bracketed key and the
+                value (everything to the right of the equals sign, as
+                before) is copied into the header with bounds checking so
+                an overlong value just gets truncated.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    Internal header to be populated
+                - text           =    The header block
+                - size           =    Number of bytes in text
+
+ - Returns:     N/A
 
+********************************************************************/
+
+static void parse_llz_header (INTERNAL_LLZ_HEADER *llz, const char *text, size_t size)
+{
+  const char *line, *end, *eol, *key, *key_end, *value;
+  size_t line_length, key_length, value_length;
+  char info[1024];
+  int32_t i, flag, stats_keys = 0;
+  int64_t compressed_records = 0;
+  double extent[6];
 
-  /*  The first time through we want to initialize the llz handle array.  */
 
-  if (first)
+  for (line = text, end = text + size ; line < end ; line = eol + 1)
     {
-      for (i = 0 ; i < MAX_LLZ_FILES ; i++) 
+      if ((eol = memchr (line, '\n', end - line)) == NULL) eol = end;
+
+
+      /*  Strip the carriage return (if any) just like ngets did.  */
+
+      line_length = eol - line;
+      while (line_length && line[line_length - 1] == '\r') line_length--;
+
+      if (!line_length || line[0] != '[' || (key_end = memchr (line, ']', line_length)) == NULL) continue;
+
+      key = line + 1;
+      key_length = key_end - key;
+
+      for (i = 0 ; i < LLZ_KEY_COUNT ; i++)
+        {
+          if (llz_keys[i].length == key_length && !memcmp (llz_keys[i].name, key, key_length)) break;
+        }
+
+      if (i == LLZ_KEY_COUNT) continue;
+
+      if (llz_keys[i].key == LLZ_KEY_END_OF_HEADER) break;
+
+
+      /*  Everything to the right of the equals sign is the value.  */
+
+      if ((value = memchr (key_end, '=', line + line_length - key_end)) == NULL) continue;
+
+      value++;
+      value_length = line + line_length - value;
+
+      switch (llz_keys[i].key)
         {
-          memset (&llzh[i], 0, sizeof (INTERNAL_LLZ_HEADER));
-          llzh[i].fp = NULL;
-          llz_recnum[i] = 0;
+        case LLZ_KEY_VERSION:
+          copy_llz_value (llz->header.version, sizeof (llz->header.version), value, value_length);
+          copy_llz_value (info, sizeof (info), value, value_length);
+          llz->major_version = get_llz_major_version (info);
+          break;
+
+        case LLZ_KEY_TIME_FLAG:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          flag = 0;
+          sscanf (info, "%d", &flag);
+          llz->time_flag = llz->header.time_flag = (uint8_t) flag;
+          break;
+
+        case LLZ_KEY_UNCERTAINTY_FLAG:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          flag = 0;
+          sscanf (info, "%d", &flag);
+          llz->uncertainty_flag = llz->header.uncertainty_flag = (uint8_t) flag;
+          break;
+
+        case LLZ_KEY_DEPTH_UNITS:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          llz->depth_units = llz->header.depth_units = parse_llz_depth_units (info);
+          break;
+
+        case LLZ_KEY_ENDIAN:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          if (big_endian ())
+            {
+              llz->swap = (strstr (info, "LITTLE") != NULL);
+            }
+          else
+            {
+              llz->swap = (strstr (info, "BIG") != NULL);
+            }
+          break;
+
+        case LLZ_KEY_CLASSIFICATION:
+          copy_llz_value (llz->header.classification, sizeof (llz->header.classification), value, value_length);
+          break;
+
+        case LLZ_KEY_DISTRIBUTION:
+          copy_llz_value (llz->header.distribution, sizeof (llz->header.distribution), value, value_length);
+          break;
+
+        case LLZ_KEY_DECLASSIFICATION:
+          copy_llz_value (llz->header.declassification, sizeof (llz->header.declassification), value, value_length);
+          break;
+
+        case LLZ_KEY_CLASS_JUST:
+          copy_llz_value (llz->header.class_just, sizeof (llz->header.class_just), value, value_length);
+          break;
+
+        case LLZ_KEY_DOWNGRADE:
+          copy_llz_value (llz->header.downgrade, sizeof (llz->header.downgrade), value, value_length);
+          break;
+
+        case LLZ_KEY_SOURCE:
+          copy_llz_value (llz->header.source, sizeof (llz->header.source), value, value_length);
+          break;
+
+        case LLZ_KEY_COMMENTS:
+          copy_llz_value (llz->header.comments, sizeof (llz->header.comments), value, value_length);
+          break;
+
+        case LLZ_KEY_NUMBER_OF_RECORDS:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          sscanf (info, "%" SCNd64, &llz->number_of_records64);
+          break;
+
+        case LLZ_KEY_CREATION_DATE:
+          copy_llz_value (llz->header.creation_date, sizeof (llz->header.creation_date), value, value_length);
+          break;
+
+        case LLZ_KEY_MODIFIED_DATE:
+          copy_llz_value (llz->header.modified_date, sizeof (llz->header.modified_date), value, value_length);
+          break;
+
+        case LLZ_KEY_COMPRESSION:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          if (strstr (info, "PACKED"))
+            {
+              llz->compressed = LLZ_COMPRESSION_PACKED;
+            }
+          else if (strstr (info, "DELTA"))
+            {
+              llz->compressed = LLZ_COMPRESSION_DELTA;
+            }
+          break;
+
+        case LLZ_KEY_BLOCK_RECORDS:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          sscanf (info, "%d", &llz->block_records);
+          break;
+
+        case LLZ_KEY_BLOCK_TABLE:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          sscanf (info, "%" SCNd64, &llz->block_table);
+          break;
+
+        case LLZ_KEY_COMPRESSED_RECORDS:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          sscanf (info, "%" SCNd64, &compressed_records);
+          break;
+
+        case LLZ_KEY_VALID_COUNT:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          if (sscanf (info, "%" SCNd64, &llz->stats.valid_count) == 1) stats_keys |= 1;
+          break;
+
+        case LLZ_KEY_MIN_LAT:
+        case LLZ_KEY_MAX_LAT:
+        case LLZ_KEY_MIN_LON:
+        case LLZ_KEY_MAX_LON:
+        case LLZ_KEY_MIN_DEPTH:
+        case LLZ_KEY_MAX_DEPTH:
+          copy_llz_value (info, sizeof (info), value, value_length);
+          if (sscanf (info, "%lf", &extent[llz_keys[i].key - LLZ_KEY_MIN_LAT]) == 1) stats_keys |= 2 << (llz_keys[i].key - LLZ_KEY_MIN_LAT);
+          break;
+
+        case LLZ_KEY_END_OF_HEADER:
+          break;
         }
-      first = 0;
     }
 
 
+  /*  The real number of records in a compressed file is in [COMPRESSED RECORDS] and the compressed blocks don't
+      depend on the byte order.  */
+
+  if (llz->compressed)
+    {
+      llz->number_of_records64 = compressed_records;
+      llz->swap = 0;
+    }
+
+
+  /*  The statistics are only used if they're all there and make sense.  */
+
+  if (stats_keys == 0x7f && llz->stats.valid_count >= 0 && llz->stats.valid_count <= llz->number_of_records64)
+    {
+      llz->stats.min_lat = NINT (extent[0] * 10000000.0);
+      llz->stats.max_lat = NINT (extent[1] * 10000000.0);
+      llz->stats.min_lon = NINT (extent[2] * 10000000.0);
+      llz->stats.max_lon = NINT (extent[3] * 10000000.0);
+      llz->stats.min_depth = NINT (extent[4] * 10000.0);
+      llz->stats.max_depth = NINT (extent[5] * 10000.0);
+
+      llz->stats_state = LLZ_STATS_CURRENT;
+    }
+  else
+    {
+      memset (&llz->stats, 0, sizeof (LLZ_HEADER_STATS));
+      llz->stats_state = LLZ_STATS_UNKNOWN;
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_header_block
+
+ - Purpose:     Read the ASCII header block of an llz file with a single
+                read and make sure it is an llz file.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - fp             =    The open llz file (positioned at the
+                                      start of the file)
+                - text           =    Buffer of LLZ_HEADER_SIZE bytes for
+                                      the header block
+
+ - Returns:
+                - The number of header bytes read
+                - 0 if this isn't an llz file
+
+********************************************************************/
+
+static size_t read_llz_header_block (FILE *fp, char *text)
+{
+  char magic[129];
+  size_t size;
+
+
+  /*  The header is binary safe since we never look past what we read, but we still make sure that the version
+      string is in the first 128 bytes so that we don't try to parse some other kind of file.  */
+
+  if ((size = fread (text, 1, LLZ_HEADER_SIZE, fp)) < 128) return (0);
+
+  memcpy (magic, text, 128);
+  magic[128] = 0;
+
+  if (!strstr (magic, "llz library V")) return (0);
+
+  return (size);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    open_llz_file
+
+ - Purpose:     Open an llz file and parse the header.  This does all of
+                the work for open_llz and open_llz_mmap.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - path           =    The llz file path
+                - llz_header     =    LLZ_HEADER structure to be populated
+                - read_only      =    If set, open the file read only
+
+ - Returns:
+                - The file handle or -1 on error
+
+********************************************************************/
+
+static int32_t open_llz_file (const char *path, LLZ_HEADER *llz_header, uint8_t read_only)
+{
+  int32_t hnd;
+  size_t size;
+  char *text;
+
+
   /*  Find the next available handle and make sure we haven't opened too many.  */
 
-  hnd = MAX_LLZ_FILES;
-  for (i = 0 ; i < MAX_LLZ_FILES ; i++)
+  if ((hnd = allocate_llz_handle ()) < 0)
+    {
+      fprintf (stderr, "\n\nToo many open llz files!\n\n");
+      return (-1);
+    }
+
+
+  /*  Open the file and read the header.  */
+
+  if ((!read_only && (llzh[hnd]->fp = fopen64 (path, "rb+")) != NULL) || (llzh[hnd]->fp = fopen64 (path, "rb")) != NULL)
     {
-      if (llzh[i].fp == NULL)
+      /*  Read the whole header block at once.  The handle's staging buffer is plenty big and we'll need it
+          later anyway.  */
+
+      if ((text = (char *) get_llz_buffer (hnd, LLZ_HEADER_SIZE)) == NULL ||
+          (size = read_llz_header_block (llzh[hnd]->fp, text)) == 0)
         {
-          hnd = i;
-          llz_recnum[hnd] = 0;
-          break;
+          /*  Not an llz file (or no memory), release the handle.  */
+
+          fclose (llzh[hnd]->fp);
+          release_llz_handle (hnd);
+          return (-1);
+        }
+
+      parse_llz_header (llzh[hnd], text, size);
+
+      if ((llzh[hnd]->path = (char *) malloc (strlen (path) + 1)) != NULL) strcpy (llzh[hnd]->path, path);
+
+      llzh[hnd]->at_end = 0;
+      llzh[hnd]->size_changed = 0;
+      llzh[hnd]->modified = 0;
+      llzh[hnd]->created = 0;
+      llzh[hnd]->write = 0;
+
+      set_llz_layout (llzh[hnd]);
+
+      sync_llz_record_count (llzh[hnd]);
+
+
+      /*  Compressed files are read only once they've been closed.  */
+
+      if (llzh[hnd]->compressed)
+        {
+          llzh[hnd]->read_only = 1;
+
+          if (!open_llz_compression (llzh[hnd]))
+            {
+              fclose (llzh[hnd]->fp);
+              release_llz_handle (hnd);
+              return (-1);
+            }
         }
+
+
+      *llz_header = llzh[hnd]->header;
+    }
+  else
+    {
+      release_llz_handle (hnd);
+      hnd = -1;
     }
 
 
-  if (hnd == MAX_LLZ_FILES)
-    {
-      fprintf (stderr, "\n\nToo many open llz files!\n\n");
-      return (-1);
-    }
+  return (hnd);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    open_llz
+
+ - Purpose:     Open an llz file.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        08/31/06
+
+ - Arguments:
+                - path           =    The llz file path
+                - llz_header     =    LLZ_HEADER structure to be populated
+
+ - Returns:
+                - The file handle or -1 on error
+
+********************************************************************/
+
+int32_t open_llz (const char *path, LLZ_HEADER *llz_header)
+{
+  return (open_llz_file (path, llz_header, 0));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    open_llz_mmap
+
+ - Purpose:     Open an llz file read only and memory map the records.
+                read_llz, read_llz_range, and the other read functions
+                will decode directly from the mapping with no seeks or
+                copies.  The mapping is shared by all processes that map
+                the same file so repeatedly opening the same large file
+                is much faster.  Trying to append or update records on a
+                handle opened this way will fail.  On systems without
+                mmap the file is simply opened read only.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - path           =    The llz file path
+                - llz_header     =    LLZ_HEADER structure to be populated
+
+ - Returns:
+                - The file handle or -1 on error
+
+********************************************************************/
+
+int32_t open_llz_mmap (const char *path, LLZ_HEADER *llz_header)
+{
+  int32_t hnd;
+
+#ifndef NVWIN3X
+
+  int64_t size;
+  void *map;
+  struct stat64 st;
+
+#endif
+
+
+  if ((hnd = open_llz_file (path, llz_header, 1)) < 0) return (hnd);
+
+  llzh[hnd]->read_only = 1;
+
+#ifndef NVWIN3X
+
+  /*  There's nothing to gain from mapping a compressed file since every block has to be decompressed anyway.  */
+
+  if (llzh[hnd]->compression) return (hnd);
+
+  if (fstat64 (fileno (llzh[hnd]->fp), &st) || st.st_size <= LLZ_HEADER_SIZE) return (hnd);
+
+
+  /*  Don't map past the last complete record.  */
+
+  size = (int64_t) llzh[hnd]->number_of_records64 * (int64_t) llzh[hnd]->layout.record_size + (int64_t) LLZ_HEADER_SIZE;
+  if (size > st.st_size) size = st.st_size;
+
+
+  /*  We have to map from the beginning of the file since mmap offsets must be page aligned.  */
+
+  if ((map = mmap (NULL, (size_t) size, PROT_READ, MAP_SHARED, fileno (llzh[hnd]->fp), 0)) == MAP_FAILED) return (hnd);
+
+  llzh[hnd]->map = (uint8_t *) map;
+  llzh[hnd]->map_size = (size_t) size;
+  llzh[hnd]->map_records = (size - LLZ_HEADER_SIZE) / llzh[hnd]->layout.record_size;
+
+#endif
+
+  return (hnd);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    probe_llz
+
+ - Purpose:     Read the header of an llz file without opening it as an
+                llz file.  This reads the header block with a single read
+                and closes the file.  No handle is allocated and nothing
+                is ever written so this is safe to call from many threads
+                at once (e.g. when cataloging large numbers of files).
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - path           =    The llz file path
+                - llz_header     =    LLZ_HEADER structure to be populated
+                                      (may be NULL)
+                - llz_info       =    LLZ_INFO structure to be populated
+                                      (may be NULL)
+
+ - Returns:
+                - 0 on error or if the file is not an llz file
+                - 1
+
+********************************************************************/
+
+uint8_t probe_llz (const char *path, LLZ_HEADER *llz_header, LLZ_INFO *llz_info)
+{
+  INTERNAL_LLZ_HEADER llz;
+  FILE *fp;
+  char *text;
+  size_t size;
+
+
+  if ((fp = fopen64 (path, "rb")) == NULL) return (0);
+
+  if ((text = (char *) malloc (LLZ_HEADER_SIZE)) == NULL)
+    {
+      fclose (fp);
+      return (0);
+    }
+
+  size = read_llz_header_block (fp, text);
+
+  fclose (fp);
+
+  if (!size)
+    {
+      free (text);
+      return (0);
+    }
+
+
+  memset (&llz, 0, sizeof (INTERNAL_LLZ_HEADER));
+
+  parse_llz_header (&llz, text, size);
+
+  free (text);
+
+  set_llz_layout (&llz);
+
+  sync_llz_record_count (&llz);
+
+
+  if (llz_header) *llz_header = llz.header;
+
+  if (llz_info)
+    {
+      llz_info->major_version = llz.major_version;
+      llz_info->big_endian = big_endian () ? !llz.swap : llz.swap;
+      llz_info->swap = llz.swap;
+      llz_info->record_size = llz.layout.record_size;
+      llz_info->number_of_records = llz.number_of_records64;
+      llz_info->compressed = llz.compressed;
+    }
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    close_llz
+
+ - Purpose:     Close an llz file.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        08/31/06
+
+ - Arguments:   hnd            =    The file handle
+
+ - Returns:     void
+
+********************************************************************/
+
+void close_llz (int32_t hnd)
+{
+  char time_date[128];
+
+
+  if (!check_llz_handle (hnd)) return;
+
+  get_llz_time_string (time_date);
+
+  if (llzh[hnd]->modified)
+    {
+      strcpy (llzh[hnd]->header.modified_date, time_date);
+    }
+
+  if (llzh[hnd]->created)
+    {
+      strcpy (llzh[hnd]->header.creation_date, time_date);
+    }
+
+  if (llzh[hnd]->stream) stop_llz_stream (hnd);
+
+  if (llzh[hnd]->compression) finish_llz_compression (llzh[hnd]);
+
+  if (llzh[hnd]->size_changed || llzh[hnd]->created || llzh[hnd]->modified)
+    {
+      write_llz_header (hnd);
+    }
+
+
+  fclose (llzh[hnd]->fp);
+
+
+  /*  If we changed the file any bounding box index for it is out of date.  */
+
+  if (llzh[hnd]->modified && llzh[hnd]->path) remove_llz_index (llzh[hnd]->path);
+
+#ifndef NVWIN3X
+
+  if (llzh[hnd]->map) munmap (llzh[hnd]->map, llzh[hnd]->map_size);
+
+#endif
+
+  release_llz_handle (hnd);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz
+
+ - Purpose:     Retrieve an llz record from an llz file.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        08/31/06
+
+ - Arguments:
+                - hnd            =    The file handle
+                - recnum         =    The record number of the llz
+                                      record to be retrieved or
+                                      LLZ_NEXT_RECORD (-1)
+                - data           =    The returned llz record
+
+ - Returns:
+                - 0 on error or end of file
+                - 1
+
+********************************************************************/
+
+uint8_t read_llz (int32_t hnd, int32_t recnum, LLZ_REC *data)
+{
+  return (read_llz64 (hnd, (int64_t) recnum, data));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz64
+
+ - Purpose:     Retrieve an llz record from an llz file using a 64 bit
+                record number.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - recnum         =    The record number of the llz
+                                      record to be retrieved or
+                                      LLZ_NEXT_RECORD (-1)
+                - data           =    The returned llz record
+
+ - Returns:
+                - 0 on error or end of file
+                - 1
+
+********************************************************************/
+
+uint8_t read_llz64 (int32_t hnd, int64_t recnum, LLZ_REC *data)
+{
+  int64_t pos;
+  size_t size;
+  uint8_t rec[64];
+
+
+  if (!check_llz_handle (hnd)) return (0);
+
+
+  /*  Flush the buffer if the last thing we did was a write operation.  */
+
+  if (llzh[hnd]->write) fflush (llzh[hnd]->fp);
+
+
+  /*  Set recnum for LLZ_NEXT_RECORD  */
+
+  if (recnum < 0) 
+    {
+      if (llzh[hnd]->recnum == llzh[hnd]->number_of_records64) return (0);
+      recnum = llzh[hnd]->recnum;
+    }
+
+
+  /*  Decode straight from the mapping if the file was opened with open_llz_mmap.  */
+
+  if (llzh[hnd]->map)
+    {
+      if (recnum >= llzh[hnd]->map_records) return (0);
+
+      decode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, llzh[hnd]->map + LLZ_HEADER_SIZE +
+                          (size_t) recnum * llzh[hnd]->layout.record_size, 1, data);
+    }
+  else if (llzh[hnd]->compression)
+    {
+      if (recnum >= llzh[hnd]->number_of_records64 || !read_llz_compressed (llzh[hnd], recnum, 1, rec)) return (0);
+
+      decode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, rec, 1, data);
+    }
+  else
+    {
+      /*  The record layout (version 1.00, 2.xx/3.xx, or 4.00+) was determined when the file was opened.  */
+
+      size = llzh[hnd]->layout.record_size;
+      pos = (int64_t) recnum * (int64_t) size + (int64_t) LLZ_HEADER_SIZE;
+
+
+      /*  Reading the next record in order (e.g. with LLZ_NEXT_RECORD) is served from a read ahead buffer so
+          that we don't seek (which throws away the stdio buffer) for every record.  */
+
+      if ((recnum < llzh[hnd]->ahead_start || recnum >= llzh[hnd]->ahead_start + llzh[hnd]->ahead_count) &&
+          recnum == llzh[hnd]->recnum && recnum < llzh[hnd]->number_of_records64)
+        {
+          llzh[hnd]->ahead_count = 0;
+
+          if (llzh[hnd]->ahead || (llzh[hnd]->ahead = (uint8_t *) malloc (LLZ_READ_AHEAD_BYTES)) != NULL)
+            {
+              llzh[hnd]->ahead_start = recnum;
+              llzh[hnd]->ahead_count = (int32_t) (pread_llz_bytes (llzh[hnd], pos, (LLZ_READ_AHEAD_BYTES / size) * size,
+                                                                   llzh[hnd]->ahead) / size);
+            }
+        }
+
+      if (recnum >= llzh[hnd]->ahead_start && recnum < llzh[hnd]->ahead_start + llzh[hnd]->ahead_count)
+        {
+          decode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, llzh[hnd]->ahead + (size_t) (recnum - llzh[hnd]->ahead_start) *
+                              size, 1, data);
+        }
+      else if (llzh[hnd]->ahead || (llzh[hnd]->ahead = (uint8_t *) malloc (LLZ_READ_AHEAD_BYTES)) != NULL)
+        {
+          /*  Keep the record in the read ahead buffer so that an update of the record we just read can use it to
+              keep the header statistics up to date without reading it again.  */
+
+          llzh[hnd]->ahead_count = 0;
+
+          fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
+
+          if ((fread (llzh[hnd]->ahead, size, 1, llzh[hnd]->fp)) == 0) return (0);
+
+          llzh[hnd]->ahead_start = recnum;
+          llzh[hnd]->ahead_count = 1;
+
+          decode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, llzh[hnd]->ahead, 1, data);
+        }
+      else
+        {
+          fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
+
+          if ((fread (rec, size, 1, llzh[hnd]->fp)) == 0) return (0);
+
+          decode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, rec, 1, data);
+        }
+    }
+
+
+  /*  Set the next record number.  */
+
+  llzh[hnd]->recnum = recnum + 1;
+
+  llzh[hnd]->at_end = 0;
+  llzh[hnd]->write = 0;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    offset_llz_columns
+
+ - Purpose:     Point a set of destination arrays at element offset of
+                the base destination arrays.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - base           =    Destination arrays
+                - offset         =    Element offset
+                - dest           =    The offset destination arrays
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void offset_llz_columns (const LLZ_COLUMNS *base, int32_t offset, LLZ_COLUMNS *dest)
+{
+  size_t i = (size_t) offset;
+
+
+  *dest = *base;
+
+  if (base->stride)
+    {
+      if (dest->tv_sec) dest->tv_sec = (time_t *) ((uint8_t *) dest->tv_sec + i * base->stride);
+      if (dest->tv_nsec) dest->tv_nsec = (long *) ((uint8_t *) dest->tv_nsec + i * base->stride);
+      if (dest->uncertainty) dest->uncertainty = (float *) ((uint8_t *) dest->uncertainty + i * base->stride);
+      if (dest->lat) dest->lat = (double *) ((uint8_t *) dest->lat + i * base->stride);
+      if (dest->lon) dest->lon = (double *) ((uint8_t *) dest->lon + i * base->stride);
+      if (dest->depth) dest->depth = (float *) ((uint8_t *) dest->depth + i * base->stride);
+      if (dest->status) dest->status = (uint32_t *) ((uint8_t *) dest->status + i * base->stride);
+    }
+  else
+    {
+      if (dest->tv_sec) dest->tv_sec += i;
+      if (dest->tv_nsec) dest->tv_nsec += i;
+      if (dest->uncertainty) dest->uncertainty += i;
+      if (dest->lat) dest->lat += i;
+      if (dest->lon) dest->lon += i;
+      if (dest->depth) dest->depth += i;
+      if (dest->status) dest->status += i;
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_block
+
+ - Purpose:     Read count consecutive records starting at record start
+                and decode them into the dest arrays.  This does all of
+                the work for read_llz_range and read_llz_columns.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The record number of the first llz
+                                      record to be retrieved or
+                                      LLZ_NEXT_RECORD (-1)
+                - count          =    The number of records to retrieve
+                - dest           =    Destination arrays
+
+ - Returns:
+                - The number of records read
+                - 0 on error or end of file
+
+********************************************************************/
+
+static int32_t read_llz_block (int32_t hnd, int64_t start, int32_t count, const LLZ_COLUMNS *dest)
+{
+  int64_t pos;
+  int32_t num, done, got;
+  uint8_t *buf;
+  LLZ_COLUMNS chunk;
+
+
+  if (!check_llz_handle (hnd)) return (0);
+
+
+  /*  Flush the buffer if the last thing we did was a write operation.  */
+
+  if (llzh[hnd]->write) fflush (llzh[hnd]->fp);
+
+
+  /*  Set start for LLZ_NEXT_RECORD  */
+
+  if (start < 0) start = llzh[hnd]->recnum;
+
+
+  /*  Don't try to read past the end of the file.  */
+
+  if (start >= llzh[hnd]->number_of_records64 || count <= 0) return (0);
+
+  if (count > llzh[hnd]->number_of_records64 - start) count = (int32_t) (llzh[hnd]->number_of_records64 - start);
+
+
+  /*  Decode straight from the mapping if the file was opened with open_llz_mmap.  */
+
+  if (llzh[hnd]->map)
+    {
+      if (start >= llzh[hnd]->map_records) return (0);
+      if (count > llzh[hnd]->map_records - start) count = (int32_t) (llzh[hnd]->map_records - start);
+
+      decode_llz_block (&llzh[hnd]->layout, llzh[hnd]->swap, llzh[hnd]->map + LLZ_HEADER_SIZE +
+                        (size_t) start * llzh[hnd]->layout.record_size, count, dest);
+
+      llzh[hnd]->recnum = start + count;
+      llzh[hnd]->at_end = 0;
+
+      return (count);
+    }
+
+
+  num = count;
+  if (num > LLZ_CHUNK_RECORDS) num = LLZ_CHUNK_RECORDS;
+
+  if ((buf = get_llz_buffer (hnd, (size_t) num * llzh[hnd]->layout.record_size)) == NULL) return (0);
+
+
+  pos = (int64_t) start * (int64_t) llzh[hnd]->layout.record_size + (int64_t) LLZ_HEADER_SIZE;
+  if (!llzh[hnd]->compression) fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
+
+  for (done = 0 ; done < count ; done += got)
+    {
+      num = count - done;
+      if (num > LLZ_CHUNK_RECORDS) num = LLZ_CHUNK_RECORDS;
+
+      if (llzh[hnd]->compression)
+        {
+          got = read_llz_compressed (llzh[hnd], start + done, num, buf);
+        }
+      else
+        {
+          got = fread (buf, llzh[hnd]->layout.record_size, num, llzh[hnd]->fp);
+        }
+
+      if (got == 0) break;
+
+      offset_llz_columns (dest, done, &chunk);
+      decode_llz_block (&llzh[hnd]->layout, llzh[hnd]->swap, buf, got, &chunk);
+
+      if (got < num)
+        {
+          done += got;
+          break;
+        }
+    }
+
+
+  /*  Set the next record number.  */
+
+  llzh[hnd]->recnum = start + done;
+
+  llzh[hnd]->at_end = 0;
+  llzh[hnd]->write = 0;
+
+  return (done);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_range
+
+ - Purpose:     Retrieve count consecutive llz records from an llz file
+                starting at record start.  The packed records are read
+                from disk in large contiguous blocks and decoded in a
+                single pass.  This is much faster than calling read_llz
+                for each record.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The record number of the first llz
+                                      record to be retrieved or
+                                      LLZ_NEXT_RECORD (-1)
+                - count          =    The number of records to retrieve
+                - data           =    The returned llz records (must have
+                                      room for count records)
+
+ - Returns:
+                - The number of records read (this will be less than count
+                  if the end of the file is reached)
+                - 0 on error or end of file
+
+********************************************************************/
+
+int32_t read_llz_range (int32_t hnd, int64_t start, int32_t count, LLZ_REC *data)
+{
+  LLZ_COLUMNS dest;
+
+
+  /*  Decode straight into the LLZ_REC array by using the record size as the stride for every field.  */
+
+  dest.tv_sec = &data[0].tv_sec;
+  dest.tv_nsec = &data[0].tv_nsec;
+  dest.uncertainty = &data[0].uncertainty;
+  dest.lat = &data[0].xy.lat;
+  dest.lon = &data[0].xy.lon;
+  dest.depth = &data[0].depth;
+  dest.status = &data[0].status;
+  dest.stride = sizeof (LLZ_REC);
+
+  return (read_llz_block (hnd, start, count, &dest));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_columns
+
+ - Purpose:     Retrieve count consecutive llz records starting at record
+                start into separate arrays (structure of arrays).  Any of
+                the arrays may be NULL if you don't need that field.
+                Fields that aren't decoded aren't touched at all so this
+                is the cheapest way to pull a few fields out of a file.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The record number of the first llz
+                                      record to be retrieved or
+                                      LLZ_NEXT_RECORD (-1)
+                - count          =    The number of records to retrieve
+                - lat            =    Latitude array or NULL
+                - lon            =    Longitude array or NULL
+                - depth          =    Depth array or NULL
+                - uncertainty    =    Uncertainty array or NULL
+                - status         =    Status array or NULL
+                - tv_sec         =    POSIX seconds array or NULL
+                - tv_nsec        =    Nanoseconds array or NULL
+
+ - Returns:
+                - The number of records read (this will be less than count
+                  if the end of the file is reached)
+                - 0 on error or end of file
+
+********************************************************************/
+
+int32_t read_llz_columns (int32_t hnd, int64_t start, int32_t count, double *lat, double *lon, float *depth, float *uncertainty,
+                          uint32_t *status, time_t *tv_sec, long *tv_nsec)
+{
+  LLZ_COLUMNS dest;
+
+
+  dest.tv_sec = tv_sec;
+  dest.tv_nsec = tv_nsec;
+  dest.uncertainty = uncertainty;
+  dest.lat = lat;
+  dest.lon = lon;
+  dest.depth = depth;
+  dest.status = status;
+  dest.stride = 0;
+
+  return (read_llz_block (hnd, start, count, &dest));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pread_llz_bytes
+
+ - Purpose:     Read size bytes starting at file offset pos without
+                using or moving the FILE position.  Safe to call from
+                multiple threads on the same handle.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - pos            =    File offset
+                - size           =    Number of bytes to read
+                - buf            =    The returned bytes
+
+ - Returns:
+                - The number of bytes read
+
+********************************************************************/
+
+size_t pread_llz_bytes (const INTERNAL_LLZ_HEADER *llz, int64_t pos, size_t size, uint8_t *buf)
+{
+  size_t done;
+
+#ifndef NVWIN3X
+  ssize_t got;
+#endif
+
+
+#ifdef NVWIN3X
+
+  pthread_mutex_lock (&llz_pread_mutex);
+
+  fseeko64 (llz->fp, pos, SEEK_SET);
+  done = fread (buf, 1, size, llz->fp);
+
+  pthread_mutex_unlock (&llz_pread_mutex);
+
+#else
+
+  for (done = 0 ; done < size ; done += got)
+    {
+      got = pread (fileno (llz->fp), buf + done, size - done, (off_t) (pos + done));
+
+      if (got < 0 && errno == EINTR)
+        {
+          got = 0;
+          continue;
+        }
+
+      if (got <= 0) break;
+    }
+
+#endif
+
+  return (done);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pwrite_llz_bytes
+
+ - Purpose:     Write size bytes starting at file offset pos without
+                using or moving the FILE position.  Safe to call from
+                multiple threads on the same handle as long as they
+                write to different parts of the file.  Anything buffered
+                in the FILE must be flushed before calling this.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - pos            =    File offset
+                - size           =    Number of bytes to write
+                - buf            =    The bytes
+
+ - Returns:
+                - The number of bytes written
+
+********************************************************************/
+
+size_t pwrite_llz_bytes (const INTERNAL_LLZ_HEADER *llz, int64_t pos, size_t size, const uint8_t *buf)
+{
+  size_t done;
+
+#ifndef NVWIN3X
+  ssize_t got;
+#endif
+
+
+#ifdef NVWIN3X
+
+  pthread_mutex_lock (&llz_pread_mutex);
+
+  fseeko64 (llz->fp, pos, SEEK_SET);
+  done = fwrite (buf, 1, size, llz->fp);
+  fflush (llz->fp);
+
+  pthread_mutex_unlock (&llz_pread_mutex);
+
+#else
+
+  for (done = 0 ; done < size ; done += got)
+    {
+      got = pwrite (fileno (llz->fp), buf + done, size - done, (off_t) (pos + done));
+
+      if (got < 0 && errno == EINTR)
+        {
+          got = 0;
+          continue;
+        }
+
+      if (got <= 0) break;
+    }
+
+#endif
+
+  return (done);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pread_llz_records
+
+ - Purpose:     Read count packed records starting at record start
+                without using or moving the FILE position.  Safe to call
+                from multiple threads on the same handle.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The record number of the first record
+                - count          =    The number of records to read
+                - buf            =    The returned packed records
+
+ - Returns:
+                - The number of complete records read
+
+********************************************************************/
+
+static int32_t pread_llz_records (int32_t hnd, int64_t start, int32_t count, uint8_t *buf)
+{
+  int64_t pos;
+  size_t done;
+
+
+  if (llzh[hnd]->compression) return (pread_llz_compressed (llzh[hnd], start, count, buf));
+
+
+  pos = (int64_t) start * (int64_t) llzh[hnd]->layout.record_size + (int64_t) LLZ_HEADER_SIZE;
+
+  done = pread_llz_bytes (llzh[hnd], pos, (size_t) count * llzh[hnd]->layout.record_size, buf);
+
+
+#ifdef NVWIN3X
+
+  /*  We moved the FILE position so the next append_llz has to seek.  */
+
+  llzh[hnd]->at_end = 0;
+
+#endif
+
+  return ((int32_t) (done / llzh[hnd]->layout.record_size));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pread_llz_range
+
+ - Purpose:     Retrieve count consecutive llz records starting at
+                record start.  This is a stateless version of
+                read_llz_range that is keyed only by record number.  It
+                doesn't use or change the handle's current record, the
+                FILE position, or the staging buffer so any number of
+                threads can read different parts of the same file at the
+                same time (using pread, or the mapping if the file was
+                opened with open_llz_mmap).  Don't append or update
+                records on the handle while other threads are reading it.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The record number of the first llz
+                                      record to be retrieved
+                - count          =    The number of records to retrieve
+                - data           =    The returned llz records (must have
+                                      room for count records)
+
+ - Returns:
+                - The number of records read (this will be less than count
+                  if the end of the file is reached)
+                - 0 on error or end of file
+
+********************************************************************/
+
+int32_t pread_llz_range (int32_t hnd, int64_t start, int32_t count, LLZ_REC *data)
+{
+  int32_t num, done, got;
+  uint8_t *buf;
+
+
+  if (!check_llz_handle (hnd)) return (0);
+
+
+  /*  Don't try to read past the end of the file.  */
+
+  if (start < 0 || start >= llzh[hnd]->number_of_records64 || count <= 0) return (0);
+
+  if (count > llzh[hnd]->number_of_records64 - start) count = (int32_t) (llzh[hnd]->number_of_records64 - start);
+
+
+  if (llzh[hnd]->map)
+    {
+      if (start >= llzh[hnd]->map_records) return (0);
+      if (count > llzh[hnd]->map_records - start) count = (int32_t) (llzh[hnd]->map_records - start);
+
+      decode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, llzh[hnd]->map + LLZ_HEADER_SIZE +
+                          (size_t) start * llzh[hnd]->layout.record_size, count, data);
+
+      return (count);
+    }
+
+
+  /*  Make sure anything appended through stdio is on disk before we go around it.  */
+
+  if (llzh[hnd]->write) fflush (llzh[hnd]->fp);
+
+
+  /*  Each call gets its own buffer so that we don't share anything with other threads.  */
+
+  num = count;
+  if (num > LLZ_CHUNK_RECORDS) num = LLZ_CHUNK_RECORDS;
+
+  if ((buf = (uint8_t *) malloc ((size_t) num * llzh[hnd]->layout.record_size)) == NULL) return (0);
+
+  for (done = 0 ; done < count ; done += got)
+    {
+      num = count - done;
+      if (num > LLZ_CHUNK_RECORDS) num = LLZ_CHUNK_RECORDS;
+
+      if ((got = pread_llz_records (hnd, start + done, num, buf)) == 0) break;
+
+      decode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, buf, got, &data[done]);
+
+      if (got < num)
+        {
+          done += got;
+          break;
+        }
+    }
+
+  free (buf);
+
+  return (done);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_raw
+
+ - Purpose:     Retrieve a zero-copy view of count consecutive packed
+                llz records starting at record start.  No decoding is
+                done.  Use the llz_raw_* inline functions in llz.h to
+                byte swap and scale only the fields that you need.  If
+                the file was opened with open_llz_mmap the view points
+                directly into the mapping, otherwise the records are
+                read into a buffer that is only used by read_llz_raw.
+                In either case the view is only valid until the next
+                read_llz_raw or close_llz call on this handle.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The record number of the first llz
+                                      record to be retrieved or
+                                      LLZ_NEXT_RECORD (-1)
+                - count          =    The number of records to retrieve
+                - raw            =    The returned view of the packed records
+
+ - Returns:
+                - The number of records available in raw (this will be
+                  less than count if the end of the file is reached)
+                - 0 on error or end of file
+
+********************************************************************/
+
+int32_t read_llz_raw (int32_t hnd, int64_t start, int32_t count, LLZ_RAW *raw)
+{
+  int64_t pos;
+  size_t size;
+  uint8_t *buf;
+  LLZ_LAYOUT *layout;
+
+
+  if (!check_llz_handle (hnd)) return (0);
+
+  layout = &llzh[hnd]->layout;
+
+
+  /*  Flush the buffer if the last thing we did was a write operation.  */
+
+  if (llzh[hnd]->write) fflush (llzh[hnd]->fp);
+
+
+  /*  Set start for LLZ_NEXT_RECORD  */
+
+  if (start < 0) start = llzh[hnd]->recnum;
+
+
+  /*  Don't try to read past the end of the file.  */
+
+  if (start >= llzh[hnd]->number_of_records64 || count <= 0) return (0);
+
+  if (count > llzh[hnd]->number_of_records64 - start) count = (int32_t) (llzh[hnd]->number_of_records64 - start);
+
+
+  raw->record_size = layout->record_size;
+  raw->time_offset = layout->time_offset;
+  raw->uncertainty_offset = layout->uncertainty_offset;
+  raw->lat_offset = layout->lat_offset;
+  raw->lon_offset = layout->lat_offset + sizeof (int32_t);
+  raw->depth_offset = layout->lat_offset + 2 * sizeof (int32_t);
+  raw->stat_offset = layout->stat_offset;
+  raw->stat_size = layout->stat_size;
+  raw->swap = llzh[hnd]->swap;
+
+
+  if (llzh[hnd]->map)
+    {
+      if (start >= llzh[hnd]->map_records) return (0);
+      if (count > llzh[hnd]->map_records - start) count = (int32_t) (llzh[hnd]->map_records - start);
+
+      raw->data = llzh[hnd]->map + LLZ_HEADER_SIZE + (size_t) start * layout->record_size;
+    }
+  else
+    {
+      /*  The view gets its own buffer so that it isn't clobbered by the other read, append, and update functions
+          (which use the staging buffer).  */
+
+      size = (size_t) count * layout->record_size;
+
+      if (size > llzh[hnd]->raw_buffer_size)
+        {
+          if ((buf = (uint8_t *) realloc (llzh[hnd]->raw_buffer, size)) == NULL) return (0);
+
+          llzh[hnd]->raw_buffer = buf;
+          llzh[hnd]->raw_buffer_size = size;
+        }
+
+      buf = llzh[hnd]->raw_buffer;
+
+      if (llzh[hnd]->compression)
+        {
+          count = read_llz_compressed (llzh[hnd], start, count, buf);
+        }
+      else
+        {
+          pos = (int64_t) start * (int64_t) layout->record_size + (int64_t) LLZ_HEADER_SIZE;
+          fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
+
+          count = fread (buf, layout->record_size, count, llzh[hnd]->fp);
+        }
+
+      if (count == 0) return (0);
+
+      raw->data = buf;
+    }
+
+  raw->count = count;
+
+
+  /*  Set the next record number.  */
+
+  llzh[hnd]->recnum = start + count;
+
+  llzh[hnd]->at_end = 0;
+  llzh[hnd]->write = 0;
+
+  return (count);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    append_llz
+
+ - Purpose:     Store an llz record on the end of an llz file and update
+                the number_of_records.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        08/31/06
+
+ - Arguments:
+                - hnd            =    The file handle
+                - data           =    The llz record
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+uint8_t append_llz (int32_t hnd, LLZ_REC data)
+{
+  uint8_t rec[64];
+
+
+  if (!check_llz_handle (hnd) || llzh[hnd]->read_only || llzh[hnd]->stream) return (0);
+
+  if (llzh[hnd]->compression) return ((uint8_t) append_llz_batch (hnd, &data, 1));
+
+
+  /*  Flush the buffer if the last thing we did was a read operation.  */
+
+  if (!llzh[hnd]->write) fflush (llzh[hnd]->fp);
+
+
+  if (!llzh[hnd]->at_end) fseeko64 (llzh[hnd]->fp, 0L, SEEK_END);
+
+
+  encode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, &data, 1, rec);
+
+  if ((fwrite (rec, llzh[hnd]->layout.record_size, 1, llzh[hnd]->fp)) == 0) return (0);
+
+  add_llz_stats (llzh[hnd], rec, 1);
+
+
+  llzh[hnd]->number_of_records64++;
+  sync_llz_record_count (llzh[hnd]);
+  llzh[hnd]->size_changed = 1;
+  llzh[hnd]->modified = 1;
+  llzh[hnd]->write = 1;
+  llzh[hnd]->at_end = 1;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    append_llz_batch
+
+ - Purpose:     Store count llz records on the end of an llz file and
+                update the number_of_records.  The records are packed
+                into the handle's staging buffer and written in large
+                blocks.  The resulting file is identical to the one
+                produced by calling append_llz for each record.
 
+ - Date:        10/16/26
 
-  /*  Open the file and read the header.  */
+ - Arguments:
+                - hnd            =    The file handle
+                - data           =    The llz records
+                - count          =    The number of records in data
 
-  tf = uf = 0;
-  llzh[hnd].depth_units = 0;
-  if ((llzh[hnd].fp = fopen64 (path, "rb+")) != NULL || (llzh[hnd].fp = fopen64 (path, "rb")) != NULL)
-    {
-      /*  We want to try to read the first line (version info) with an fread in case we mistakenly asked to
-          load a binary file.  If we try to use ngets to read a binary file and there are no line feeds in 
-          the first sizeof (varin) characters we would segfault.  */
+ - Returns:
+                - The number of records appended (this will be less than
+                  count on error)
 
-      if (!fread (varin, 128, 1, llzh[hnd].fp)) return (-1);
+********************************************************************/
 
+int32_t append_llz_batch (int32_t hnd, const LLZ_REC *data, int32_t count)
+{
+  int32_t num, done, put;
+  uint8_t *buf;
 
-      /*  Check for the version.  */
 
-      if (!strstr (varin, "llz library V")) return (-1);
+  if (!check_llz_handle (hnd) || llzh[hnd]->read_only || llzh[hnd]->stream || count <= 0) return (0);
 
 
-      /*  Rewind to the beginning of the file.  Yes, we'll read the version again but it doesn't matter.  */
+  /*  Compressed records are held until there's a whole block to compress.  */
 
-      rewind (llzh[hnd].fp);
+  if (llzh[hnd]->compression)
+    {
+      done = append_llz_compressed (llzh[hnd], data, count);
 
+      sync_llz_record_count (llzh[hnd]);
 
-      while (ngets (varin, sizeof (varin), llzh[hnd].fp))
+      if (done)
         {
-          if (strstr (varin, "[END OF HEADER]")) break;
-
-
-          /*  Put everything to the right of the equals sign in 'info'.   */
+          llzh[hnd]->size_changed = 1;
+          llzh[hnd]->modified = 1;
+        }
 
-          if (strchr (varin, '=') != NULL) strcpy (info, (strchr (varin, '=') + 1));
+      return (done);
+    }
 
-          if (strstr (varin, "[VERSION]"))
-            {
-	      strcpy(llzh[hnd].header.version, info);
-	      strcpy(token, strtok(info, "V"));
-	      strcpy(token, strtok(NULL, info));
-	      strcpy(token, strtok(token, " "));
 
-	      llzh[hnd].major_version = (uint16_t) atoi(token);
-            }
+  num = count;
+  if (num > LLZ_CHUNK_RECORDS) num = LLZ_CHUNK_RECORDS;
 
-          if (strstr (varin, "[TIME FLAG]")) sscanf (info, "%d", &tf);
+  if ((buf = get_llz_buffer (hnd, (size_t) num * llzh[hnd]->layout.record_size)) == NULL) return (0);
 
-          if (strstr (varin, "[UNCERTAINTY FLAG]")) sscanf (info, "%d", &uf);
 
-          if (strstr (varin, "[DEPTH UNITS]")) sscanf (info, "%c", &llzh[hnd].depth_units);
+  /*  Flush the buffer if the last thing we did was a read operation.  */
 
-          if (strstr (varin, "[ENDIAN]"))
-            {
-              if (big_endian ())
-                {
-                  if (strstr (info, "LITTLE"))
-                    {
-                      llzh[hnd].swap = 1;
-                    }
-                  else
-                    {
-                      llzh[hnd].swap = 0;
-                    }
-                }
-              else
-                {
-                  if (strstr (info, "BIG"))
-                    {
-                      llzh[hnd].swap = 1;
-                    }
-                  else
-                    {
-                      llzh[hnd].swap = 0;
-                    }
-                }
-            }
+  if (!llzh[hnd]->write) fflush (llzh[hnd]->fp);
 
-          if (strstr (varin, "[CLASSIFICATION]")) strcpy (llzh[hnd].header.classification, info);
 
-          if (strstr (varin, "[DISTRIBUTION]")) strcpy (llzh[hnd].header.distribution, info);
+  if (!llzh[hnd]->at_end) fseeko64 (llzh[hnd]->fp, 0L, SEEK_END);
 
-          if (strstr (varin, "[DECLASSIFICATION]")) strcpy (llzh[hnd].header.declassification, info);
 
-          if (strstr (varin, "[CLASSIFICATION JUSTIFICATION]")) strcpy (llzh[hnd].header.class_just, info);
+  llzh[hnd]->write = 1;
+  llzh[hnd]->at_end = 1;
 
-          if (strstr (varin, "[DOWNGRADE]")) strcpy (llzh[hnd].header.downgrade, info);
+  for (done = 0 ; done < count ; done += put)
+    {
+      num = count - done;
+      if (num > LLZ_CHUNK_RECORDS) num = LLZ_CHUNK_RECORDS;
 
-          if (strstr (varin, "[SOURCE]")) strcpy (llzh[hnd].header.source, info);
+      encode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, &data[done], num, buf);
 
-          if (strstr (varin, "[COMMENTS]")) strcpy (llzh[hnd].header.comments, info);
+      put = fwrite (buf, llzh[hnd]->layout.record_size, num, llzh[hnd]->fp);
 
-          if (strstr (varin, "[NUMBER OF RECORDS]")) sscanf (info, "%d", &llzh[hnd].header.number_of_records);
+      add_llz_stats (llzh[hnd], buf, put);
 
-          if (strstr (varin, "[CREATION DATE]")) strcpy (llzh[hnd].header.creation_date, info);
+      llzh[hnd]->number_of_records64 += put;
+      sync_llz_record_count (llzh[hnd]);
 
-          if (strstr (varin, "[LAST MODIFIED DATE]")) strcpy (llzh[hnd].header.modified_date, info);
+      if (put < num)
+        {
+          done += put;
+          break;
         }
-
-      llzh[hnd].time_flag = llzh[hnd].header.time_flag = (uint8_t) tf;
-      llzh[hnd].uncertainty_flag = llzh[hnd].header.uncertainty_flag = (uint8_t) uf;
-      llzh[hnd].depth_units = llzh[hnd].header.depth_units;
-      llzh[hnd].at_end = 0;
-      llzh[hnd].size_changed = 0;
-      llzh[hnd].modified = 0;
-      llzh[hnd].created = 0;
-      llzh[hnd].write = 0;
+    }
 
 
-      *llz_header = llzh[hnd].header;
-    }
-  else
+  if (done)
     {
-      hnd = -1;
+      llzh[hnd]->size_changed = 1;
+      llzh[hnd]->modified = 1;
     }
 
-
-  return (hnd);
+  return (done);
 }
 
 
 /********************************************************************/
 /*!
 
- - Function:    close_llz
-
- - Purpose:     Close an llz file.
+ - Function:    get_llz_ahead
 
- - Author:      Jan C. Depner (area.based.editor@gmail.com)
+ - Purpose:     Find packed records in the read_llz read ahead buffer.
+                The update functions use this to get the old records
+                for the header statistics without reading them again.
 
- - Date:        08/31/06
+ - Date:        10/16/26
 
- - Arguments:   hnd            =    The file handle
+ - Arguments:
+                - hnd            =    The file handle
+                - recnum         =    The first record number
+                - count          =    Number of records
 
- - Returns:     void
+ - Returns:
+                - Pointer to the first packed record
+                - NULL if the records aren't all in the read ahead buffer
 
 ********************************************************************/
 
-void close_llz (int32_t hnd)
+static const uint8_t *get_llz_ahead (int32_t hnd, int64_t recnum, int32_t count)
 {
-  time_t systemtime;
-  char time_date[128];
+  if (!llzh[hnd]->ahead || recnum < llzh[hnd]->ahead_start ||
+      recnum + count > llzh[hnd]->ahead_start + llzh[hnd]->ahead_count) return (NULL);
 
-  systemtime = time (&systemtime);
-  strcpy (time_date, asctime (localtime (&systemtime)));
+  return (llzh[hnd]->ahead + (size_t) (recnum - llzh[hnd]->ahead_start) * llzh[hnd]->layout.record_size);
+}
 
-  time_date[strlen (time_date) - 1] = 0;
 
-  if (llzh[hnd].modified)
-    {
-      strcpy (llzh[hnd].header.modified_date, time_date);
-    }
+/********************************************************************/
+/*!
 
-  if (llzh[hnd].created)
-    {
-      strcpy (llzh[hnd].header.creation_date, time_date);
-    }
+ - Function:    update_llz
+
+ - Purpose:     Store an llz record at the recnum record location in
+                an llz file.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        08/31/06
 
-  if (llzh[hnd].size_changed || llzh[hnd].created || llzh[hnd].modified) write_llz_header (hnd);
+ - Arguments:
+                - hnd            =    The file handle
+                - recnum         =    The record number
+                - data           =    The llz record
+
+ - Returns:
+                - 0 on error
+                - 1
 
+********************************************************************/
 
-  fclose (llzh[hnd].fp);
-  llzh[hnd].fp = NULL;
-  memset (&llzh[hnd], 0, sizeof (INTERNAL_LLZ_HEADER));
-  llzh[hnd].fp = NULL;
+uint8_t update_llz (int32_t hnd, int32_t recnum, LLZ_REC data)
+{
+  return (update_llz64 (hnd, (int64_t) recnum, data));
 }
 
 
 /********************************************************************/
 /*!
 
- - Function:    read_llz
-
- - Purpose:     Retrieve an llz record from an llz file.
+ - Function:    update_llz64
 
- - Author:      Jan C. Depner (area.based.editor@gmail.com)
+ - Purpose:     Store an llz record at the recnum record location in
+                an llz file using a 64 bit record number.
 
- - Date:        08/31/06
+ - Date:        10/16/26
 
  - Arguments:
                 - hnd            =    The file handle
-                - recnum         =    The record number of the llz
-                                      record to be retrieved or
-                                      LLZ_NEXT_RECORD (-1)
-                - data           =    The returned llz record
+                - recnum         =    The record number
+                - data           =    The llz record
 
  - Returns:
-                - 0 on error or end of file
+                - 0 on error
                 - 1
 
 ********************************************************************/
 
-uint8_t read_llz (int32_t hnd, int32_t recnum, LLZ_REC *data)
+uint8_t update_llz64 (int32_t hnd, int64_t recnum, LLZ_REC data)
 {
   int64_t pos;
-  int32_t tmpi;
-  INTERNAL_LLZ llz;
+  uint8_t rec[64];
+  const uint8_t *old_rec;
 
 
-  /*  Flush the buffer if the last thing we did was a write operation.  */
+  if (!check_llz_handle (hnd) || llzh[hnd]->read_only || llzh[hnd]->compression || llzh[hnd]->stream || recnum < 0 ||
+      recnum > llzh[hnd]->number_of_records64 - 1) return (0);
 
-  if (llzh[hnd].write) fflush (llzh[hnd].fp);
 
+  /*  Flush the buffer if the last thing we did was a read operation.  */
 
-  /*  Set recnum for LLZ_NEXT_RECORD  */
+  if (!llzh[hnd]->write) fflush (llzh[hnd]->fp);
 
-  if (recnum < 0) 
-    {
-      if (llz_recnum[hnd] == llzh[hnd].header.number_of_records) return (0);
-      recnum = llz_recnum[hnd];
-    }
 
+  /*  We need the old record to keep the header statistics up to date.  If read_llz didn't leave it in the read
+      ahead buffer we don't read it again, the statistics just become unknown.  */
 
-  /*  Version 1.00 files.  */
+  if ((old_rec = get_llz_ahead (hnd, recnum, 1)) == NULL) llzh[hnd]->stats_state = LLZ_STATS_UNKNOWN;
 
-  if (llzh[hnd].major_version < 2)
-    {
-      pos = (int64_t) recnum * 4L * (int64_t) sizeof (int32_t) + (int64_t) LLZ_HEADER_SIZE;
-      fseeko64 (llzh[hnd].fp, pos, SEEK_SET);
 
-      llz.tv_sec = 0;
-      llz.tv_nsec = 0;
-      llz.uncertainty = 0.0;
+  /*  The records in the read ahead buffer are about to change (the buffer itself isn't touched until the next
+      read_llz so old_rec is still good).  */
 
-      if ((fread (&llz.lat, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&llz.lon, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&llz.dep, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&tmpi, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
+  llzh[hnd]->ahead_count = 0;
 
 
-      /*  Deal with the 16 bit v1.0 status.  */
+  encode_llz_records (&llzh[hnd]->layout, llzh[hnd]->swap, &data, 1, rec);
 
-      if (llzh[hnd].swap)
-	{
-	  swap_int (&tmpi);
-	  llz.stat = (uint16_t) tmpi;
-	  swap_int ((int32_t *) &llz.stat);
-	}
-      else
-	{
-	  llz.stat = (uint16_t) tmpi;
-	}
-    }
 
+  /*  The record layout (version 1.00, 2.xx/3.xx, or 4.00+) was determined when the file was opened.  */
+
+  pos = (int64_t) recnum * (int64_t) llzh[hnd]->layout.record_size + (int64_t) LLZ_HEADER_SIZE;
 
-  /* Version > 2-3 files that were created during the 'default to version 0' bug */
 
-  else if(llzh[hnd].major_version < 4 && llzh[hnd].major_version >= 2)
+  fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
+
+  if ((fwrite (rec, llzh[hnd]->layout.record_size, 1, llzh[hnd]->fp)) == 0)
     {
-      rewind(llzh[hnd].fp);
+      /*  We don't know what made it to disk.  */
+
+      llzh[hnd]->stats_state = LLZ_STATS_UNKNOWN;
 
-      pos = (int64_t) recnum * 4L * (int64_t) sizeof (int32_t) + (int64_t) LLZ_HEADER_SIZE;
+      return (0);
+    }
 
+  if (old_rec && llzh[hnd]->stats_state == LLZ_STATS_CURRENT) change_llz_stats (llzh[hnd], old_rec, rec, 1);
 
-      /*  all version above 1 have TIME FLAG  */
 
-      if (llzh[hnd].time_flag)
-	{
-	  pos += (int64_t) recnum * (2L * (int64_t) sizeof (int32_t));
-	}
+  /*  We're no longer positioned at the end of the file so the next append_llz has to seek.  */
 
+  llzh[hnd]->at_end = 0;
+  llzh[hnd]->modified = 1;
+  llzh[hnd]->write = 1;
 
-      /*Version 3 has uncertainty*/
+  return (1);
+}
 
-      if(llzh[hnd].major_version==3)
-	{
-	  if (llzh[hnd].uncertainty_flag)
-	    {
-	      pos += (int64_t) recnum * ((int64_t) sizeof (int32_t));
-	    }
-	}
 
-      fseeko64 (llzh[hnd].fp, pos, SEEK_SET);
+/*  Updates sorted by record number.  The original position is kept so that when the same record is updated
+    more than once the last update wins (and so update_llz_batch can find the record).  */
 
-      llz.tv_sec = 0;
-      llz.tv_nsec = 0;
-      llz.uncertainty = 0.0;
+typedef struct
+{
+  int64_t       recnum;
+  int32_t       order;
+  uint32_t      status;               /*!<  Only used by update_llz_status  */
+} LLZ_UPDATE_SORT;
 
 
-      /* all version above 1 have TIME FLAG */      
+/*  Status updates closer together than this many bytes are done by reading, patching, and rewriting the whole
+    span of records instead of seeking to and writing each status field separately.  */
 
-      if (llzh[hnd].time_flag)
-	{
-	  if ((fread (&llz.tv_sec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	  if ((fread (&llz.tv_nsec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	}
+#define LLZ_STATUS_GAP 8192
 
 
-      /* Version 3 has uncertainty */
+/********************************************************************/
+/*!
 
-      if (llzh[hnd].major_version==3)
-	{
-	  if (llzh[hnd].uncertainty_flag)
-	    {
-	      if ((fread (&llz.uncertainty, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) 
-		return (0);
-	    }
-	}
-      
+ - Function:    compare_llz_update
 
-      if ((fread (&llz.lat, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&llz.lon, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&llz.dep, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&tmpi, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
+ - Purpose:     qsort comparison function for LLZ_UPDATE_SORT.
 
+ - Date:        10/16/26
 
-      /*  Deal with the 16 bit v1.0 status.  */
+ - Arguments:
+                - a              =    First update
+                - b              =    Second update
 
-      if (llzh[hnd].swap)
-	{
-	  swap_int (&tmpi);
-	  llz.stat = (uint16_t) tmpi;
-	  swap_int ((int32_t *) &llz.stat);
-	}
-      else
-	{
-	  llz.stat = (uint16_t) tmpi;
-	}
-    }
+ - Returns:     -1, 0, or 1
 
+********************************************************************/
 
-  /* Version > 4 using a uint16_t status instead of uint32_t */
+static int32_t compare_llz_update (const void *a, const void *b)
+{
+  const LLZ_UPDATE_SORT *sa = (const LLZ_UPDATE_SORT *) a;
+  const LLZ_UPDATE_SORT *sb = (const LLZ_UPDATE_SORT *) b;
 
-  else
-    {
-      rewind(llzh[hnd].fp);
-
-      pos = (int64_t) recnum * (3L * (int64_t) sizeof (int32_t) + (int64_t) sizeof (uint16_t)) + (int64_t) LLZ_HEADER_SIZE;
-
-      if (llzh[hnd].time_flag)
-	{
-	  pos += (int64_t) recnum * (2L * (int64_t) sizeof (int32_t));
-	}
-	
-      if (llzh[hnd].uncertainty_flag)
-	{
-	  pos += (int64_t) recnum * ((int64_t) sizeof (int32_t));
-	}
-
-      fseeko64 (llzh[hnd].fp, pos, SEEK_SET);
-
-      llz.tv_sec = 0;
-      llz.tv_nsec = 0;
-      llz.uncertainty = 0.0;
-
-      if (llzh[hnd].time_flag)
-	{
-	  if ((fread (&llz.tv_sec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	  if ((fread (&llz.tv_nsec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	}
-
-      if (llzh[hnd].uncertainty_flag)
-	{
-	  if ((fread (&llz.uncertainty, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	}
-
-      if ((fread (&llz.lat, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&llz.lon, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&llz.dep, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fread (&llz.stat, sizeof (uint16_t), 1, llzh[hnd].fp)) == 0) return (0);
-    }
 
+  if (sa->recnum < sb->recnum) return (-1);
+  if (sa->recnum > sb->recnum) return (1);
+  if (sa->order < sb->order) return (-1);
+  if (sa->order > sb->order) return (1);
+
+  return (0);
+}
 
-  /*  Set the next record number.  */
 
-  llz_recnum[hnd]++;
+/********************************************************************/
+/*!
 
-  if (llzh[hnd].swap) swap_internal_llz (&llz);
+ - Function:    sort_llz_updates
 
-  data->tv_sec = llz.tv_sec;
-  data->tv_nsec = llz.tv_nsec;
-  data->uncertainty = (float) llz.uncertainty / 10000.0L;
-  data->xy.lat = (double) llz.lat / 10000000.0L;
-  data->xy.lon = (double) llz.lon / 10000000.0L;
-  data->depth = (float) llz.dep / 10000.0L;
-  data->status = (uint32_t) llz.stat;
+ - Purpose:     Sort updates by record number (and therefore by file
+                offset) and remove duplicates, keeping the last update
+                of each record.
 
-  llzh[hnd].at_end = 0;
-  llzh[hnd].write = 0;
+ - Date:        10/16/26
 
-  return (1);
+ - Arguments:
+                - sorted         =    The updates
+                - count          =    The number of updates
+
+ - Returns:     The number of updates left
+
+********************************************************************/
+
+static int32_t sort_llz_updates (LLZ_UPDATE_SORT *sorted, int32_t count)
+{
+  int32_t i, j;
+
+
+  qsort (sorted, count, sizeof (LLZ_UPDATE_SORT), compare_llz_update);
+
+  for (i = j = 0 ; i < count ; i++)
+    {
+      if (j && sorted[j - 1].recnum == sorted[i].recnum)
+        {
+          sorted[j - 1] = sorted[i];
+        }
+      else
+        {
+          sorted[j++] = sorted[i];
+        }
+    }
+
+  return (j);
 }
 
 
 /********************************************************************/
 /*!
 
- - Function:    append_llz
-
- - Purpose:     Store an llz record on the end of an llz file and update
-                the number_of_records.
+ - Function:    update_llz_status
 
- - Author:      Jan C. Depner (area.based.editor@gmail.com)
+ - Purpose:     Change only the status of a list of llz records.  The
+                updates are sorted and duplicates are removed (the last
+                update of a record wins).  Isolated updates write just the
+                2 or 4 byte status field.  Updates that are close together
+                are coalesced into a single read and write of the records
+                that they span.  The rest of each record is never
+                re-encoded so this is much faster than calling update_llz
+                when all that is changing is the status (e.g. setting or
+                clearing LLZ_MANUALLY_INVAL).
 
- - Date:        08/31/06
+ - Date:        10/16/26
 
  - Arguments:
                 - hnd            =    The file handle
-                - data           =    The llz record
+                - updates        =    Record numbers and new status values
+                                      (in any order)
+                - count          =    The number of updates
 
  - Returns:
+                - The number of records updated (updates with invalid
+                  record numbers are ignored and duplicates are only
+                  counted once)
                 - 0 on error
-                - 1
 
 ********************************************************************/
 
-uint8_t append_llz (int32_t hnd, LLZ_REC data)
+int32_t update_llz_status (int32_t hnd, const LLZ_STATUS_UPDATE *updates, int32_t count)
 {
-  INTERNAL_LLZ llz;
+  LLZ_UPDATE_SORT *sorted;
+  LLZ_LAYOUT *layout;
+  int32_t i, j, k, n, span, done;
+  int64_t pos, first;
+  uint8_t *buf, *rec, field[sizeof (uint32_t)], old_rec[64], new_rec[64];
+  const uint8_t *ahead_rec;
 
 
-  /*  Flush the buffer if the last thing we did was a read operation.  */
+  if (!check_llz_handle (hnd) || llzh[hnd]->read_only || llzh[hnd]->compression || llzh[hnd]->stream || count <= 0) return (0);
 
-  if (!llzh[hnd].write) fflush (llzh[hnd].fp);
+  layout = &llzh[hnd]->layout;
 
+  if ((sorted = (LLZ_UPDATE_SORT *) malloc ((size_t) count * sizeof (LLZ_UPDATE_SORT))) == NULL) return (0);
 
-  if (!llzh[hnd].at_end) fseeko64 (llzh[hnd].fp, 0L, SEEK_END);
 
+  /*  Drop anything that isn't in the file, sort the rest, and then remove duplicates (keeping the last).  */
+
+  for (i = n = 0 ; i < count ; i++)
+    {
+      if (updates[i].recnum < 0 || updates[i].recnum >= llzh[hnd]->number_of_records64) continue;
 
-  llz.tv_sec = data.tv_sec;
-  llz.tv_nsec = data.tv_nsec;
-  llz.uncertainty = NINT (data.uncertainty * 10000.0L);
-  llz.lat = NINT (data.xy.lat * 10000000.0L);
-  llz.lon = NINT (data.xy.lon * 10000000.0L);
-  llz.dep = NINT (data.depth * 10000.0L);
-  llz.stat = (uint16_t) data.status;
+      sorted[n].recnum = updates[i].recnum;
+      sorted[n].status = updates[i].status;
+      sorted[n].order = i;
+      n++;
+    }
 
+  n = sort_llz_updates (sorted, n);
 
-  /*  Swap it if the file was originally swapped.  */
 
-  if (llzh[hnd].swap) swap_internal_llz (&llz);
+  /*  Flush the buffer if the last thing we did was a read operation.  */
 
+  if (!llzh[hnd]->write) fflush (llzh[hnd]->fp);
 
-  if (llzh[hnd].time_flag)
-    {
-      if ((fwrite (&llz.tv_sec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.tv_nsec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-    }
 
-  if (llzh[hnd].uncertainty_flag)
+  for (i = done = 0 ; i < n ; i = j)
     {
-      if ((fwrite (&llz.uncertainty, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-    }
+      /*  Find the end of the span of updates that are close enough together to do with one read and write.  */
 
-  if ((fwrite (&llz.lat, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-  if ((fwrite (&llz.lon, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-  if ((fwrite (&llz.dep, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0); 
+      first = sorted[i].recnum;
 
+      for (j = i + 1 ; j < n ; j++)
+        {
+          if ((sorted[j].recnum - sorted[j - 1].recnum) * layout->record_size > LLZ_STATUS_GAP ||
+              sorted[j].recnum - first >= LLZ_CHUNK_RECORDS) break;
+        }
 
-  /*  Version 1.00 files.  */
+      pos = first * (int64_t) layout->record_size + (int64_t) LLZ_HEADER_SIZE;
 
-  if (llzh[hnd].major_version < 2)
-    {
-      if ((fwrite (&llz.stat, sizeof (uint32_t), 1, llzh[hnd].fp)) == 0) return (0);
-    }
+      if (j - i == 1)
+        {
+          encode_llz_status (layout, llzh[hnd]->swap, sorted[i].status, field);
 
 
-  /* Version > 2-3 files that were created during the 'default to version 0' bug */ 
+          /*  We need the old record to keep the header statistics up to date.  Reading it would double the I/O
+              of an isolated status change so if it isn't in the read ahead buffer the statistics just become
+              unknown.  */
 
-  else if(llzh[hnd].major_version < 4 && llzh[hnd].major_version >= 2) 
-    {
-      if ((fwrite (&llz.stat, sizeof (uint32_t), 1, llzh[hnd].fp)) == 0) return (0);
-    }
+          if (llzh[hnd]->stats_state == LLZ_STATS_CURRENT)
+            {
+              if ((ahead_rec = get_llz_ahead (hnd, first, 1)) != NULL)
+                {
+                  memcpy (new_rec, ahead_rec, layout->record_size);
+                  memcpy (new_rec + layout->stat_offset, field, layout->stat_size);
 
+                  change_llz_stats (llzh[hnd], ahead_rec, new_rec, 1);
+                }
+              else
+                {
+                  llzh[hnd]->stats_state = LLZ_STATS_UNKNOWN;
+                }
+            }
 
-  /* Version > 4 using a uint16_t status instead of uint32_t */
+          fseeko64 (llzh[hnd]->fp, pos + layout->stat_offset, SEEK_SET);
 
-  else
-    {
-      if ((fwrite (&llz.stat, sizeof (uint16_t), 1, llzh[hnd].fp)) == 0) return (0);
+          if (fwrite (field, layout->stat_size, 1, llzh[hnd]->fp) != 1) break;
+        }
+      else
+        {
+          span = (int32_t) (sorted[j - 1].recnum - first) + 1;
+
+          if ((buf = get_llz_buffer (hnd, (size_t) span * layout->record_size)) == NULL) break;
+
+          fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
+
+          if ((int32_t) fread (buf, layout->record_size, span, llzh[hnd]->fp) != span) break;
+
+          for (k = i ; k < j ; k++)
+            {
+              rec = buf + (size_t) (sorted[k].recnum - first) * layout->record_size;
+
+              memcpy (old_rec, rec, layout->record_size);
+
+              encode_llz_status (layout, llzh[hnd]->swap, sorted[k].status, rec + layout->stat_offset);
+
+              change_llz_stats (llzh[hnd], old_rec, rec, 1);
+            }
+
+          fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
+
+          if ((int32_t) fwrite (buf, layout->record_size, span, llzh[hnd]->fp) != span) break;
+        }
+
+      done += j - i;
     }
 
+  free (sorted);
 
-  llzh[hnd].header.number_of_records++;
-  llzh[hnd].size_changed = 1;
-  llzh[hnd].modified = 1;
-  llzh[hnd].write = 1;
-  llzh[hnd].at_end = 1;
 
-  return (1);
+  /*  The records in the read ahead buffer have changed (we kept them until now for the header statistics).  */
+
+  llzh[hnd]->ahead_count = 0;
+
+
+  /*  If a write failed we don't know which of the status changes made it to disk.  */
+
+  if (i < n) llzh[hnd]->stats_state = LLZ_STATS_UNKNOWN;
+
+
+  /*  We're no longer positioned at the end of the file so the next append_llz has to seek.  */
+
+  llzh[hnd]->at_end = 0;
+  llzh[hnd]->write = 1;
+  if (done) llzh[hnd]->modified = 1;
+
+  return (done);
 }
 
 
 /********************************************************************/
 /*!
 
- - Function:    update_llz
-
- - Purpose:     Store an llz record at the recnum record location in
-                an llz file.
+ - Function:    update_llz_batch
 
- - Author:      Jan C. Depner (area.based.editor@gmail.com)
+ - Purpose:     Store count llz records at the given record locations in
+                an llz file.  The updates are sorted by file offset and
+                duplicates are removed (the last update of a record wins).
+                Runs of consecutive records are encoded into the staging
+                buffer and written with a single seek and write so the
+                file is updated in one forward pass no matter what order
+                the records were supplied in.
 
- - Date:        08/31/06
+ - Date:        10/16/26
 
  - Arguments:
                 - hnd            =    The file handle
-                - recnum         =    The record number
-                - data           =    The llz record
+                - recnums        =    The record numbers
+                - recs           =    The llz records
+                - count          =    The number of records
 
  - Returns:
+                - The number of records updated (records with invalid
+                  record numbers are ignored and duplicates are only
+                  counted once)
                 - 0 on error
-                - 1
 
 ********************************************************************/
 
-uint8_t update_llz (int32_t hnd, int32_t recnum, LLZ_REC data)
+int32_t update_llz_batch (int32_t hnd, const int64_t *recnums, const LLZ_REC *recs, int32_t count)
 {
+  LLZ_UPDATE_SORT *sorted;
+  LLZ_LAYOUT *layout;
+  int32_t i, j, k, m, n, done;
   int64_t pos;
-  INTERNAL_LLZ llz;
+  uint8_t *buf;
+  const uint8_t *old_buf;
 
 
-  if (recnum > llzh[hnd].header.number_of_records - 1) return (0);
+  if (!check_llz_handle (hnd) || llzh[hnd]->read_only || llzh[hnd]->compression || llzh[hnd]->stream || count <= 0) return (0);
 
+  layout = &llzh[hnd]->layout;
 
-  /*  Flush the buffer if the last thing we did was a read operation.  */
-
-  if (!llzh[hnd].write) fflush (llzh[hnd].fp);
+  if ((buf = get_llz_buffer (hnd, (size_t) LLZ_CHUNK_RECORDS * layout->record_size)) == NULL) return (0);
 
-  llz.tv_sec = data.tv_sec;
-  llz.tv_nsec = data.tv_nsec;
-  llz.uncertainty = NINT (data.uncertainty * 10000.0L);
-  llz.lat = NINT (data.xy.lat * 10000000.0L);
-  llz.lon = NINT (data.xy.lon * 10000000.0L);
-  llz.dep = NINT (data.depth * 10000.0L);
-  llz.stat = (uint16_t) data.status;
+  if ((sorted = (LLZ_UPDATE_SORT *) malloc ((size_t) count * sizeof (LLZ_UPDATE_SORT))) == NULL) return (0);
 
 
-  /*  Swap it if the file was originally swapped.  */
+  /*  Drop anything that isn't in the file, sort the rest by offset, and then remove duplicates.  */
 
-  if (llzh[hnd].swap) swap_internal_llz (&llz);
+  for (i = n = 0 ; i < count ; i++)
+    {
+      if (recnums[i] < 0 || recnums[i] >= llzh[hnd]->number_of_records64) continue;
 
+      sorted[n].recnum = recnums[i];
+      sorted[n].order = i;
+      sorted[n].status = 0;
+      n++;
+    }
 
-  /*  Version 1.00 files.  */
+  n = sort_llz_updates (sorted, n);
 
-  if (llzh[hnd].major_version < 2)
-    {
-      pos = (int64_t) recnum * 4L * (int64_t) sizeof (int32_t) + (int64_t) LLZ_HEADER_SIZE;
-      fseeko64 (llzh[hnd].fp, pos, SEEK_SET);
 
-      if ((fwrite (&llz.lat, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.lon, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.dep, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.stat, sizeof (uint32_t), 1, llzh[hnd].fp)) == 0) return (0);
-    }
+  /*  Flush the buffer if the last thing we did was a read operation.  */
 
+  if (!llzh[hnd]->write) fflush (llzh[hnd]->fp);
 
-  /* Version > 2-3 files that were created during the 'default to version 0' bug */ 
 
-  else if(llzh[hnd].major_version < 4 && llzh[hnd].major_version >= 2)
+  for (i = done = 0 ; i < n ; i = j)
     {
-      pos = (int64_t) recnum * 4L * (int64_t) sizeof (int32_t) + (int64_t) LLZ_HEADER_SIZE;
-
+      /*  Find the end of the run of consecutive records.  */
 
-      /* all version above 1 have TIME FLAG */            
+      for (j = i + 1 ; j < n && j - i < LLZ_CHUNK_RECORDS && sorted[j].recnum == sorted[j - 1].recnum + 1 ; j++);
 
-      if (llzh[hnd].time_flag) pos += (int64_t) recnum * (2L * (int64_t) sizeof (int32_t));
 
+      /*  Encode the run.  Records that were also consecutive in the caller's array are encoded together.  */
 
-      /* verison3 has uncert */      
+      for (k = i ; k < j ; k += m)
+        {
+          for (m = 1 ; k + m < j && sorted[k + m].order == sorted[k].order + m ; m++);
 
-      if(llzh[hnd].major_version ==3)
-	{
-	  if (llzh[hnd].uncertainty_flag) pos += (int64_t) recnum * ((int64_t) sizeof (int32_t));
-	}
-      fseeko64 (llzh[hnd].fp, pos, SEEK_SET);
+          encode_llz_records (layout, llzh[hnd]->swap, &recs[sorted[k].order], m, buf + (size_t) (k - i) * layout->record_size);
+        }
 
+      pos = sorted[i].recnum * (int64_t) layout->record_size + (int64_t) LLZ_HEADER_SIZE;
 
-      /* all version above 1 have TIME FLAG */      
+      /*  We need the old records to keep the header statistics up to date.  If they aren't in the read ahead
+          buffer we don't read them again, the statistics just become unknown.  */
 
-      if (llzh[hnd].time_flag)
-	{
-	  if ((fwrite (&llz.tv_sec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	  if ((fwrite (&llz.tv_nsec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	}
+      if ((old_buf = get_llz_ahead (hnd, sorted[i].recnum, j - i)) == NULL) llzh[hnd]->stats_state = LLZ_STATS_UNKNOWN;
 
+      fseeko64 (llzh[hnd]->fp, pos, SEEK_SET);
 
-      /* verison3 has uncert */      
+      if ((int32_t) fwrite (buf, layout->record_size, j - i, llzh[hnd]->fp) != j - i) break;
 
-      if(llzh[hnd].major_version ==3)
-	{
-	  if (llzh[hnd].uncertainty_flag)
-	    {
-	      if ((fwrite (&llz.uncertainty, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	    }
-	}
+      if (old_buf && llzh[hnd]->stats_state == LLZ_STATS_CURRENT) change_llz_stats (llzh[hnd], old_buf, buf, j - i);
 
-      if ((fwrite (&llz.lat, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.lon, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.dep, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.stat, sizeof (uint32_t), 1, llzh[hnd].fp)) == 0) return (0);
+      done += j - i;
     }
 
+  free (sorted);
 
-  /* Version > 4 using a uint16_t status instead of uint32_t */
 
-  else
-    {
-      pos = (int64_t) recnum * (3L * (int64_t) sizeof (int32_t) + (int64_t) sizeof (uint16_t)) + (int64_t) LLZ_HEADER_SIZE;
+  /*  The records in the read ahead buffer have changed (we kept them until now for the header statistics).  */
 
-      if (llzh[hnd].time_flag) pos += (int64_t) recnum * (2L * (int64_t) sizeof (int32_t));
-      if (llzh[hnd].uncertainty_flag) pos += (int64_t) recnum * ((int64_t) sizeof (int32_t));
+  llzh[hnd]->ahead_count = 0;
 
-      fseeko64 (llzh[hnd].fp, pos, SEEK_SET);
 
-      if (llzh[hnd].time_flag)
-	{
-	  if ((fwrite (&llz.tv_sec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	  if ((fwrite (&llz.tv_nsec, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	}
+  /*  If a write failed we don't know which of the records made it to disk.  */
 
-      if (llzh[hnd].uncertainty_flag)
-	{
-	  if ((fwrite (&llz.uncertainty, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-	}
+  if (i < n) llzh[hnd]->stats_state = LLZ_STATS_UNKNOWN;
 
-      if ((fwrite (&llz.lat, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.lon, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.dep, sizeof (int32_t), 1, llzh[hnd].fp)) == 0) return (0);
-      if ((fwrite (&llz.stat, sizeof (uint16_t), 1, llzh[hnd].fp)) == 0) return (0);
-    }
 
-  llzh[hnd].modified = 1;
-  llzh[hnd].write = 1;
+  /*  We're no longer positioned at the end of the file so the next append_llz has to seek.  */
 
-  return (1);
+  llzh[hnd]->at_end = 0;
+  llzh[hnd]->write = 1;
+  if (done) llzh[hnd]->modified = 1;
+
+  return (done);
 }
 
 
@@ -1032,5 +2994,59 @@ uint8_t update_llz (int32_t hnd, int32_t recnum, LLZ_REC data)
 
 int32_t ftell_llz (int32_t hnd)
 {
-  return (ftell (llzh[hnd].fp));
+  if (!check_llz_handle (hnd)) return (-1);
+
+  return (ftell (llzh[hnd]->fp));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    ftell_llz64
+
+ - Purpose:     Returns the 64 bit location of the pointer within the
+                LLZ file.  Use this instead of ftell_llz for files larger
+                than 2GB.
+
+ - Date:        10/16/26
+
+ - Arguments:   hnd            =    The file handle
+
+ - Returns:     int64_t       =    location or -1 on error
+
+********************************************************************/
+
+int64_t ftell_llz64 (int32_t hnd)
+{
+  if (!check_llz_handle (hnd)) return (-1);
+
+  return ((int64_t) ftello64 (llzh[hnd]->fp));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_record_count64
+
+ - Purpose:     Returns the 64 bit number of records in an llz file.
+                The number_of_records field of LLZ_HEADER is only 32
+                bits (it's set to INT32_MAX for files with more records
+                than that) and can't be widened without breaking
+                programs built against older versions of the library.
+
+ - Date:        10/16/26
+
+ - Arguments:   hnd            =    The file handle
+
+ - Returns:     int64_t       =    number of records or -1 on error
+
+********************************************************************/
+
+int64_t get_llz_record_count64 (int32_t hnd)
+{
+  if (!check_llz_handle (hnd)) return (-1);
+
+  return (llzh[hnd]->number_of_records64);
 }
@@ -46,6 +46,7 @@ extern "C" {
 
 
 #include <time.h>
+#include <string.h>
 #include "nvutility.h"
 
 
@@ -122,10 +123,48 @@ extern "C" {
 
        The status bits are explained in llz.h.
 
+       Files created with create_llz_compressed store the records in independently compressed blocks.  The
+       header of a compressed file has [NUMBER OF RECORDS] = 0 (so older versions of the library see an empty
+       file) and these additional keys:
+
+       <pre>
+       [COMPRESSION] = PACKED
+       [BLOCK RECORDS] =
+       [BLOCK TABLE] =
+       [COMPRESSED RECORDS] =
+       </pre>
+
+       [BLOCK RECORDS] is the number of records in each block (the last block may have fewer), [BLOCK TABLE]
+       is the file offset of the table of block offsets that follows the blocks, and [COMPRESSED RECORDS] is
+       the real number of records.  [COMPRESSION] is DELTA for files whose blocks only use variable length
+       integer deltas.  The block formats are described in llz_compress.c.
+
+       Files written by version 4.28 and later of the library also keep statistics of the valid records (those
+       with no LLZ_INVAL bits set) in the header so that the extents of a file can be found (with
+       get_llz_stats) without reading the records:
+
+       <pre>
+       [VALID COUNT] =
+       [MIN LAT] =
+       [MAX LAT] =
+       [MIN LON] =
+       [MAX LON] =
+       [MIN DEPTH] =
+       [MAX DEPTH] =
+       </pre>
+
+       These are kept up to date as records are appended or updated.  Updates get the old records from the
+       read_llz read ahead buffer.  If an update can't be accounted for without reading records (the record
+       wasn't just read with read_llz, or a valid record on the edge of the extents was changed or invalidated)
+       the keys are dropped from the header when the file is closed rather than reading the whole file.
+       get_llz_stats will then compute them by reading every record.  Older versions of the library drop them
+       when they rewrite the header, so if they are present they are correct.
+
 */
 
 
-#define MAX_LLZ_FILES 32
+#define MAX_LLZ_FILES 32         /*!<  No longer a limit, handles are allocated as needed up to LLZ_MAX_HANDLES  */
+#define LLZ_MAX_HANDLES 65536
 #define LLZ_HEADER_SIZE 16384
 
 
@@ -139,6 +178,10 @@ extern "C" {
 #define LLZ_NEXT_RECORD -1
 
 
+#define LLZ_HILBERT_ORDER 0             /*!<  sort_llz along a Hilbert curve  */
+#define LLZ_MORTON_ORDER 1              /*!<  sort_llz along a Z-order (Morton) curve  */
+
+
 typedef struct
 {
   char                 version[50];
@@ -154,7 +197,7 @@ typedef struct
   char                 comments[500];
   char                 creation_date[30];
   char                 modified_date[30];
-  int32_t              number_of_records;
+  int32_t              number_of_records;      /*!<  Set to INT32_MAX if there are more records, use get_llz_record_count64  */
 } LLZ_HEADER;
 
 typedef struct
@@ -168,13 +211,179 @@ typedef struct
 } LLZ_REC;
 
 
+/*!  Zero-copy view of a block of packed, on-disk llz records as returned by read_llz_raw.  The offsets describe
+     the record layout for the file's version and time/uncertainty flags.  Use the llz_raw_* inline functions to
+     decode only the fields that you actually need.  */
+
+typedef struct
+{
+  const uint8_t        *data;                  /*!<  Pointer to the first packed record  */
+  int32_t              count;                  /*!<  Number of records available at data  */
+  uint16_t             record_size;            /*!<  Size, in bytes, of a packed record  */
+  int16_t              time_offset;            /*!<  Offset of tv_sec (tv_nsec follows it) or -1 if no time  */
+  int16_t              uncertainty_offset;     /*!<  Offset of uncertainty or -1 if no uncertainty  */
+  uint16_t             lat_offset;             /*!<  Offset of latitude  */
+  uint16_t             lon_offset;             /*!<  Offset of longitude  */
+  uint16_t             depth_offset;           /*!<  Offset of depth  */
+  uint16_t             stat_offset;            /*!<  Offset of status  */
+  uint8_t              stat_size;              /*!<  2 for version 4.00 and later, 4 for earlier versions  */
+  uint8_t              swap;                   /*!<  Set if the records need to be byte swapped  */
+} LLZ_RAW;
+
+
+/*!  File information returned by probe_llz along with the header.  */
+
+typedef struct
+{
+  uint16_t             major_version;          /*!<  Major version of the library that created the file  */
+  uint8_t              big_endian;             /*!<  Set if the records are stored big endian  */
+  uint8_t              swap;                   /*!<  Set if the records need to be byte swapped on this system  */
+  uint16_t             record_size;            /*!<  Size, in bytes, of a packed record  */
+  int64_t              number_of_records;      /*!<  64 bit number of records  */
+  uint8_t              compressed;             /*!<  Set if the records are block compressed  */
+} LLZ_INFO;
+
+
+/*!  Statistics of the valid records (no LLZ_INVAL bits set) returned by get_llz_stats.  */
+
+typedef struct
+{
+  int64_t              valid_count;            /*!<  Number of valid records  */
+  double               min_lat;
+  double               max_lat;
+  double               min_lon;
+  double               max_lon;
+  float                min_depth;
+  float                max_depth;
+} LLZ_STATS;
+
+
+/*!  A status change for update_llz_status.  */
+
+typedef struct
+{
+  int64_t              recnum;                 /*!<  Record number  */
+  uint32_t             status;                 /*!<  New status  */
+} LLZ_STATUS_UPDATE;
+
+
+/*!  Callback for read_llz_async.  Called with each batch of count decoded records starting at record start of the
+     file opened as hnd.  The records are only valid until the callback returns.  */
+
+typedef void (*LLZ_ASYNC_CALLBACK) (int32_t hnd, int64_t start, int32_t count, const LLZ_REC *data, void *user_data);
+
+
+/*!  A reducer for reduce_llz.  Each thread gets its own state_size bytes of state which are set up by init, fed
+     batches of decoded records by reduce, and then merged (in record order) into the result by merge.  finish (which
+     may be NULL) is called once on the final result.  param is passed to all of them.  */
+
+typedef struct
+{
+  size_t               state_size;             /*!<  Size, in bytes, of the state (and the result)  */
+  void                 (*init) (void *state, const void *param);
+  void                 (*reduce) (void *state, int64_t start, int32_t count, const LLZ_REC *data, const void *param);
+  void                 (*merge) (void *state, const void *other, const void *param);
+  void                 (*finish) (void *state, const void *param);
+  const void           *param;
+} LLZ_REDUCER;
+
+
+/*!  Result of llz_bbox_reducer.  Only valid records (no LLZ_INVAL bits set) are included.  */
+
+typedef struct
+{
+  int64_t              count;                  /*!<  Number of valid records  */
+  double               min_lat;
+  double               max_lat;
+  double               min_lon;
+  double               max_lon;
+} LLZ_BBOX;
+
+
+/*!  Result of llz_depth_reducer.  Only valid records (no LLZ_INVAL bits set) are included.  */
+
+typedef struct
+{
+  int64_t              count;                  /*!<  Number of valid records  */
+  float                min_depth;
+  float                max_depth;
+  double               mean;
+  double               variance;               /*!<  Population variance  */
+  double               m2;                     /*!<  Sum of squared differences from the mean (used while reducing)  */
+} LLZ_DEPTH_STATS;
+
+
+/*!  Result of llz_status_reducer.  */
+
+typedef struct
+{
+  int64_t              total;                  /*!<  Number of records  */
+  int64_t              valid;                  /*!<  Records with no LLZ_INVAL bits set  */
+  int64_t              manually_invalid;       /*!<  Records with LLZ_MANUALLY_INVAL set  */
+  int64_t              filter_invalid;         /*!<  Records with LLZ_FILTER_INVAL set  */
+} LLZ_STATUS_COUNTS;
+
+
+#define LLZ_HISTOGRAM_BINS 1024          /*!<  Maximum number of bins in an LLZ_DEPTH_HISTOGRAM  */
+
+
+/*!  Result of llz_histogram_reducer.  The param of the reducer must point to an LLZ_DEPTH_HISTOGRAM with
+     min_depth, max_depth, and bins set.  Bin i counts valid depths from min_depth + i * width up to (but not
+     including) the next bin where width = (max_depth - min_depth) / bins.  */
+
+typedef struct
+{
+  double               min_depth;
+  double               max_depth;
+  int32_t              bins;                   /*!<  1 to LLZ_HISTOGRAM_BINS  */
+  int64_t              below;                  /*!<  Valid depths less than min_depth  */
+  int64_t              above;                  /*!<  Valid depths greater than or equal to max_depth  */
+  int64_t              count[LLZ_HISTOGRAM_BINS];
+} LLZ_DEPTH_HISTOGRAM;
+
+
+  extern const LLZ_REDUCER llz_bbox_reducer;
+  extern const LLZ_REDUCER llz_depth_reducer;
+  extern const LLZ_REDUCER llz_status_reducer;
+  extern const LLZ_REDUCER llz_histogram_reducer;
+
+
   int32_t create_llz (const char *path, LLZ_HEADER llz_header);
+  int32_t create_llz_compressed (const char *path, LLZ_HEADER llz_header);
   int32_t open_llz (const char *path, LLZ_HEADER *llz_header);
+  int32_t open_llz_mmap (const char *path, LLZ_HEADER *llz_header);
+  uint8_t probe_llz (const char *path, LLZ_HEADER *llz_header, LLZ_INFO *llz_info);
+  uint8_t get_llz_stats (int32_t hnd, LLZ_STATS *stats);
   void close_llz (int32_t hnd);
   uint8_t read_llz (int32_t hnd, int32_t recnum, LLZ_REC *data);
+  uint8_t read_llz64 (int32_t hnd, int64_t recnum, LLZ_REC *data);
+  int32_t read_llz_range (int32_t hnd, int64_t start, int32_t count, LLZ_REC *data);
+  int32_t read_llz_columns (int32_t hnd, int64_t start, int32_t count, double *lat, double *lon, float *depth, float *uncertainty,
+                            uint32_t *status, time_t *tv_sec, long *tv_nsec);
+  int32_t read_llz_raw (int32_t hnd, int64_t start, int32_t count, LLZ_RAW *raw);
+  int32_t pread_llz_range (int32_t hnd, int64_t start, int32_t count, LLZ_REC *data);
+  uint8_t start_llz_stream (int32_t hnd, int64_t start);
+  int32_t read_llz_stream (int32_t hnd, LLZ_REC *data, int32_t count);
+  int32_t read_llz_stream_raw (int32_t hnd, LLZ_RAW *raw);
+  void stop_llz_stream (int32_t hnd);
+  int64_t read_llz_async (const int32_t *hnd, int32_t files, int32_t depth, LLZ_ASYNC_CALLBACK callback, void *user_data);
   uint8_t append_llz (int32_t hnd, LLZ_REC data);
+  int32_t append_llz_batch (int32_t hnd, const LLZ_REC *data, int32_t count);
   uint8_t update_llz (int32_t hnd, int32_t recnum, LLZ_REC data);
+  uint8_t update_llz64 (int32_t hnd, int64_t recnum, LLZ_REC data);
+  int32_t update_llz_batch (int32_t hnd, const int64_t *recnums, const LLZ_REC *recs, int32_t count);
+  int32_t update_llz_status (int32_t hnd, const LLZ_STATUS_UPDATE *updates, int32_t count);
+  uint8_t create_llz_index (const char *path);
+  uint8_t sort_llz (const char *in_path, const char *out_path, int32_t order);
+  uint8_t merge_llz (const char **in_paths, int32_t count, const char *out_path, int32_t threads);
+  int64_t reduce_llz (int32_t hnd, int64_t start, int64_t count, const LLZ_REDUCER *reducer, void *result, int32_t threads);
+  int32_t read_llz_bbox (int32_t hnd, double min_lat, double min_lon, double max_lat, double max_lon, int64_t *cursor,
+                         int64_t *recnums, LLZ_REC *data, int32_t count);
+  int32_t read_llz_time_range (int32_t hnd, time_t start_sec, long start_nsec, time_t end_sec, long end_nsec, int64_t *cursor,
+                               int64_t *recnums, LLZ_REC *data, int32_t count);
   int32_t ftell_llz (int32_t hnd);
+  int64_t ftell_llz64 (int32_t hnd);
+  int64_t get_llz_record_count64 (int32_t hnd);
 
 
 #define             LLZ_MANUALLY_INVAL      1       /*!<  Point has been manually marked as invalid : 0000 0000 0000 0001 */
@@ -182,6 +391,76 @@ typedef struct
 #define             LLZ_INVAL               3       /*!<  Mask to check for either type of invalidity : 0000 0000 0000 0011 */
 
 
+  /*  Inline field decoders for LLZ_RAW records.  These do the byte swapping and scaling only for the field that
+      is asked for.  The scaling is identical to read_llz.  The record number is relative to raw->data.  */
+
+  static inline int32_t llz_raw_int32 (const LLZ_RAW *raw, int32_t rec, int32_t offset)
+  {
+    const uint8_t *ptr = raw->data + (size_t) rec * raw->record_size + offset;
+    uint32_t word;
+
+    memcpy (&word, ptr, sizeof (uint32_t));
+
+    if (raw->swap) word = (word >> 24) | ((word >> 8) & 0x0000ff00) | ((word << 8) & 0x00ff0000) | (word << 24);
+
+    return ((int32_t) word);
+  }
+
+  static inline double llz_raw_lat (const LLZ_RAW *raw, int32_t rec)
+  {
+    return ((double) llz_raw_int32 (raw, rec, raw->lat_offset) / 10000000.0);
+  }
+
+  static inline double llz_raw_lon (const LLZ_RAW *raw, int32_t rec)
+  {
+    return ((double) llz_raw_int32 (raw, rec, raw->lon_offset) / 10000000.0);
+  }
+
+  static inline float llz_raw_depth (const LLZ_RAW *raw, int32_t rec)
+  {
+    return ((float) llz_raw_int32 (raw, rec, raw->depth_offset) / 10000.0f);
+  }
+
+  static inline float llz_raw_uncertainty (const LLZ_RAW *raw, int32_t rec)
+  {
+    if (raw->uncertainty_offset < 0) return (0.0);
+
+    return ((float) llz_raw_int32 (raw, rec, raw->uncertainty_offset) / 10000.0f);
+  }
+
+  static inline time_t llz_raw_tv_sec (const LLZ_RAW *raw, int32_t rec)
+  {
+    if (raw->time_offset < 0) return (0);
+
+    return ((time_t) llz_raw_int32 (raw, rec, raw->time_offset));
+  }
+
+  static inline long llz_raw_tv_nsec (const LLZ_RAW *raw, int32_t rec)
+  {
+    if (raw->time_offset < 0) return (0);
+
+    return ((long) llz_raw_int32 (raw, rec, raw->time_offset + sizeof (int32_t)));
+  }
+
+  static inline uint32_t llz_raw_status (const LLZ_RAW *raw, int32_t rec)
+  {
+    const uint8_t *ptr;
+    uint16_t stat16;
+
+
+    /*  Pre-4.00 files store the 16 bit status in a 32 bit field.  */
+
+    if (raw->stat_size == sizeof (uint32_t)) return ((uint32_t) (uint16_t) llz_raw_int32 (raw, rec, raw->stat_offset));
+
+    ptr = raw->data + (size_t) rec * raw->record_size + raw->stat_offset;
+    memcpy (&stat16, ptr, sizeof (uint16_t));
+
+    if (raw->swap) stat16 = (uint16_t) ((stat16 >> 8) | (stat16 << 8));
+
+    return ((uint32_t) stat16);
+  }
+
+
 #ifdef  __cplusplus
 }
 #endif
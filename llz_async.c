@@ -0,0 +1,910 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+/*  Asynchronous multi-file reads.  read_llz_async keeps many block reads outstanding across any number of open
+    llz files so that fast storage (e.g. NVMe arrays) that a single blocking reader can't keep busy is kept busy.
+    On Linux the reads are submitted through io_uring (using the raw system calls so that we don't need liburing).
+    If io_uring isn't available (older kernels, other systems, or seccomp filters that block it) the same reads are
+    done by a small pool of pread threads.  Either way the completed blocks are decoded and handed to the caller's
+    callback in the calling thread so the callback doesn't have to be thread safe.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "llz_internal.h"
+
+#if defined(__linux__) && defined(__GNUC__) && !defined(LLZ_NO_IO_URING) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define LLZ_IO_URING
+#endif
+#endif
+
+#ifdef LLZ_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+
+/*  Size, in bytes, of each uncompressed block read.  Compressed files are read one compressed block at a time.  */
+
+#define LLZ_ASYNC_BYTES 1048576
+
+
+/*  Default and maximum number of reads in flight, and the maximum number of threads in the fallback pool.  */
+
+#define LLZ_ASYNC_DEPTH 32
+#define LLZ_ASYNC_MAX_DEPTH 1024
+#define LLZ_ASYNC_THREADS 16
+
+
+/*  One read.  Each slot has its own buffers and is reused as soon as its records have been delivered.  */
+
+typedef struct
+{
+  int32_t       hnd;
+  INTERNAL_LLZ_HEADER *llz;
+  int64_t       start;                /*!<  First record  */
+  int32_t       count;                /*!<  Number of records  */
+  int64_t       block;                /*!<  Compressed block number or -1  */
+  int64_t       pos;                  /*!<  File offset  */
+  size_t        size;                 /*!<  Bytes to read  */
+  size_t        done;                 /*!<  Bytes read  */
+  uint8_t       error;
+  uint8_t       *buffer;              /*!<  What we read  */
+  uint8_t       *rec;                 /*!<  Decompressed records (compressed files only)  */
+  LLZ_REC       *data;                /*!<  Decoded records  */
+} LLZ_ASYNC_SLOT;
+
+
+/*  State shared with the fallback thread pool.  Slot numbers waiting to be read are in queue and slot numbers
+    that have been read are in finished.  */
+
+typedef struct
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t work;
+  pthread_cond_t done;
+  LLZ_ASYNC_SLOT *slot;
+  int32_t       *queue;
+  int32_t       queue_head;
+  int32_t       queue_count;
+  int32_t       *finished;
+  int32_t       finished_count;
+  int32_t       depth;
+  uint8_t       stop;
+} LLZ_ASYNC_POOL;
+
+
+#ifdef LLZ_IO_URING
+
+/*  The parts of an io_uring that we use.  */
+
+typedef struct
+{
+  int32_t       fd;
+  uint32_t      *sq_head;
+  uint32_t      *sq_tail;
+  uint32_t      *sq_mask;
+  uint32_t      *sq_array;
+  uint32_t      *cq_head;
+  uint32_t      *cq_tail;
+  uint32_t      *cq_mask;
+  struct io_uring_cqe *cqes;
+  struct io_uring_sqe *sqes;
+  void          *sq_ring;
+  size_t        sq_size;
+  void          *cq_ring;
+  size_t        cq_size;
+  size_t        sqe_size;
+  struct iovec  *iov;
+  uint32_t      to_submit;
+  uint8_t       stuck;                /*!<  Set if reads may still be in flight after an error  */
+} LLZ_URING;
+
+#endif
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    next_llz_async_read
+
+ - Purpose:     Set up the next read for a file.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - slot           =    The slot to use
+                - hnd            =    The file handle
+                - llz            =    The internal llz header
+                - next           =    Next record to read from this file
+                                      (advanced past this read)
+                - chunk_records  =    Records per uncompressed read
+
+ - Returns:
+                - 0 if there's nothing left to read in this file
+                - 1
+
+********************************************************************/
+
+static uint8_t next_llz_async_read (LLZ_ASYNC_SLOT *slot, int32_t hnd, INTERNAL_LLZ_HEADER *llz, int64_t *next, int32_t chunk_records)
+{
+  int64_t n = llz->number_of_records64;
+
+
+  if (*next >= n) return (0);
+
+  slot->hnd = hnd;
+  slot->llz = llz;
+  slot->start = *next;
+  slot->done = 0;
+  slot->error = 0;
+
+  if (llz->compression)
+    {
+      slot->block = *next / llz->block_records;
+      slot->count = (int32_t) (n - *next < llz->block_records ? n - *next : llz->block_records);
+      slot->pos = llz->compression->offset[slot->block];
+      slot->size = (size_t) (llz->compression->offset[slot->block + 1] - slot->pos);
+    }
+  else
+    {
+      slot->block = -1;
+      slot->count = (int32_t) (n - *next < chunk_records ? n - *next : chunk_records);
+      slot->pos = *next * llz->layout.record_size + LLZ_HEADER_SIZE;
+      slot->size = (size_t) slot->count * llz->layout.record_size;
+    }
+
+  *next += slot->count;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    deliver_llz_async_read
+
+ - Purpose:     Decode a completed read and hand the records to the
+                callback.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - slot           =    The completed read
+                - callback       =    The caller's callback
+                - user_data      =    Passed to the callback
+
+ - Returns:
+                - The number of records delivered
+                - -1 on a read error or a corrupt compressed block
+
+********************************************************************/
+
+static int32_t deliver_llz_async_read (LLZ_ASYNC_SLOT *slot, LLZ_ASYNC_CALLBACK callback, void *user_data)
+{
+  const uint8_t *rec = slot->buffer;
+
+
+  /*  Finish short reads (e.g. io_uring can stop at a page cache boundary) synchronously.  */
+
+  if (!slot->error && slot->done < slot->size)
+    slot->done += pread_llz_bytes (slot->llz, slot->pos + slot->done, slot->size - slot->done, slot->buffer + slot->done);
+
+  if (slot->error || slot->done < slot->size) return (-1);
+
+  if (slot->block >= 0)
+    {
+      if (!decompress_llz_block (slot->llz, slot->block, slot->buffer, slot->rec)) return (-1);
+
+      rec = slot->rec;
+    }
+
+  decode_llz_records (&slot->llz->layout, slot->llz->swap, rec, slot->count, slot->data);
+
+  (*callback) (slot->hnd, slot->start, slot->count, slot->data, user_data);
+
+  return (slot->count);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    llz_async_worker
+
+ - Purpose:     Fallback thread pool worker.  Reads queued slots with
+                pread until it's told to stop.
+
+ - Date:        10/16/26
+
+ - Arguments:   arg            =    The pool
+
+ - Returns:     NULL
+
+********************************************************************/
+
+static void *llz_async_worker (void *arg)
+{
+  LLZ_ASYNC_POOL *pool = (LLZ_ASYNC_POOL *) arg;
+  LLZ_ASYNC_SLOT *slot;
+  int32_t s;
+
+
+  pthread_mutex_lock (&pool->mutex);
+
+  while (1)
+    {
+      while (!pool->stop && !pool->queue_count) pthread_cond_wait (&pool->work, &pool->mutex);
+
+      if (pool->stop) break;
+
+      s = pool->queue[pool->queue_head];
+      pool->queue_head = (pool->queue_head + 1) % pool->depth;
+      pool->queue_count--;
+
+      pthread_mutex_unlock (&pool->mutex);
+
+      slot = &pool->slot[s];
+      slot->done = pread_llz_bytes (slot->llz, slot->pos, slot->size, slot->buffer);
+
+      pthread_mutex_lock (&pool->mutex);
+
+      pool->finished[pool->finished_count++] = s;
+      pthread_cond_signal (&pool->done);
+    }
+
+  pthread_mutex_unlock (&pool->mutex);
+
+  return (NULL);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    run_llz_async_pool
+
+ - Purpose:     Do all of the reads with the fallback thread pool.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - slot           =    The slots
+                - depth          =    Number of slots
+                - hnd            =    The file handles
+                - files          =    Number of file handles
+                - next           =    Next record to read from each file
+                - chunk_records  =    Records per uncompressed read
+                - callback       =    The caller's callback
+                - user_data      =    Passed to the callback
+
+ - Returns:
+                - The number of records delivered
+                - -1 on error
+
+********************************************************************/
+
+static int64_t run_llz_async_pool (LLZ_ASYNC_SLOT *slot, int32_t depth, const int32_t *hnd, int32_t files, int64_t *next,
+                                   int32_t chunk_records, LLZ_ASYNC_CALLBACK callback, void *user_data)
+{
+  LLZ_ASYNC_POOL pool;
+  pthread_t thread[LLZ_ASYNC_THREADS];
+  int32_t threads, i, s, file = 0, busy = 0, got;
+  int64_t total = 0;
+  uint8_t error = 0;
+
+
+  memset (&pool, 0, sizeof (LLZ_ASYNC_POOL));
+
+  pool.slot = slot;
+  pool.depth = depth;
+
+  if ((pool.queue = (int32_t *) malloc (depth * sizeof (int32_t))) == NULL ||
+      (pool.finished = (int32_t *) malloc (depth * sizeof (int32_t))) == NULL)
+    {
+      if (pool.queue) free (pool.queue);
+      return (-1);
+    }
+
+  pthread_mutex_init (&pool.mutex, NULL);
+  pthread_cond_init (&pool.work, NULL);
+  pthread_cond_init (&pool.done, NULL);
+
+  threads = depth < LLZ_ASYNC_THREADS ? depth : LLZ_ASYNC_THREADS;
+
+  for (i = 0 ; i < threads ; i++)
+    {
+      if (pthread_create (&thread[i], NULL, llz_async_worker, &pool)) break;
+    }
+
+  threads = i;
+
+  if (!threads) error = 1;
+
+
+  /*  Queue a read in every slot, then refill each slot as soon as its records have been delivered.  Files are
+      read round robin so that all of them are being read at once.  */
+
+  for (s = 0 ; s < depth ; s++) pool.finished[s] = s;
+  pool.finished_count = depth;
+
+  while (!error)
+    {
+      pthread_mutex_lock (&pool.mutex);
+
+      while (pool.finished_count)
+        {
+          s = pool.finished[--pool.finished_count];
+
+
+          /*  Slots that were never used have nothing to deliver.  */
+
+          if (slot[s].llz)
+            {
+              pthread_mutex_unlock (&pool.mutex);
+
+              busy--;
+
+              if ((got = deliver_llz_async_read (&slot[s], callback, user_data)) < 0) error = 1;
+              total += got;
+
+              pthread_mutex_lock (&pool.mutex);
+
+              if (error) break;
+            }
+
+          slot[s].llz = NULL;
+
+          for (i = 0 ; i < files ; i++, file = (file + 1) % files)
+            {
+              if (next_llz_async_read (&slot[s], hnd[file], get_llz_handle (hnd[file]), &next[file], chunk_records))
+                {
+                  file = (file + 1) % files;
+
+                  pool.queue[(pool.queue_head + pool.queue_count) % depth] = s;
+                  pool.queue_count++;
+                  busy++;
+
+                  pthread_cond_signal (&pool.work);
+                  break;
+                }
+            }
+        }
+
+      if (error || !busy)
+        {
+          pthread_mutex_unlock (&pool.mutex);
+          break;
+        }
+
+      while (!pool.finished_count) pthread_cond_wait (&pool.done, &pool.mutex);
+
+      pthread_mutex_unlock (&pool.mutex);
+    }
+
+
+  pthread_mutex_lock (&pool.mutex);
+
+  pool.stop = 1;
+  pthread_cond_broadcast (&pool.work);
+
+  pthread_mutex_unlock (&pool.mutex);
+
+  for (i = 0 ; i < threads ; i++) pthread_join (thread[i], NULL);
+
+  pthread_mutex_destroy (&pool.mutex);
+  pthread_cond_destroy (&pool.work);
+  pthread_cond_destroy (&pool.done);
+
+  free (pool.queue);
+  free (pool.finished);
+
+  if (error) return (-1);
+
+  return (total);
+}
+
+
+#ifdef LLZ_IO_URING
+
+/********************************************************************/
+/*!
+
+ - Function:    close_llz_uring
+
+ - Purpose:     Unmap and close an io_uring.
+
+ - Date:        10/16/26
+
+ - Arguments:   ring           =    The ring
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void close_llz_uring (LLZ_URING *ring)
+{
+  if (ring->sqes && ring->sqes != MAP_FAILED) munmap (ring->sqes, ring->sqe_size);
+  if (ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) munmap (ring->cq_ring, ring->cq_size);
+  if (ring->sq_ring && ring->sq_ring != MAP_FAILED) munmap (ring->sq_ring, ring->sq_size);
+  if (ring->iov) free (ring->iov);
+
+  close (ring->fd);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    open_llz_uring
+
+ - Purpose:     Set up an io_uring with room for depth reads.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ring           =    The ring
+                - depth          =    Number of reads in flight
+
+ - Returns:
+                - 0 if io_uring isn't available
+                - 1
+
+********************************************************************/
+
+static uint8_t open_llz_uring (LLZ_URING *ring, int32_t depth)
+{
+  struct io_uring_params params;
+  uint8_t *sq, *cq;
+
+
+  memset (ring, 0, sizeof (LLZ_URING));
+  memset (&params, 0, sizeof (params));
+
+  if ((ring->fd = (int32_t) syscall (__NR_io_uring_setup, (unsigned) depth, &params)) < 0) return (0);
+
+  ring->sq_size = params.sq_off.array + params.sq_entries * sizeof (uint32_t);
+  ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+
+
+  /*  Newer kernels map both rings with one mmap.  */
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+      if (ring->cq_size > ring->sq_size) ring->sq_size = ring->cq_size;
+      ring->cq_size = ring->sq_size;
+    }
+
+  ring->sq_ring = mmap (NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+
+  if (ring->sq_ring == MAP_FAILED)
+    {
+      close_llz_uring (ring);
+      return (0);
+    }
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+      ring->cq_ring = ring->sq_ring;
+    }
+  else
+    {
+      ring->cq_ring = mmap (NULL, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    }
+
+  ring->sqe_size = params.sq_entries * sizeof (struct io_uring_sqe);
+  ring->sqes = (struct io_uring_sqe *) mmap (NULL, ring->sqe_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                                             IORING_OFF_SQES);
+
+  if (ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED ||
+      (ring->iov = (struct iovec *) calloc (depth, sizeof (struct iovec))) == NULL)
+    {
+      close_llz_uring (ring);
+      return (0);
+    }
+
+  sq = (uint8_t *) ring->sq_ring;
+  cq = (uint8_t *) ring->cq_ring;
+
+  ring->sq_head = (uint32_t *) (sq + params.sq_off.head);
+  ring->sq_tail = (uint32_t *) (sq + params.sq_off.tail);
+  ring->sq_mask = (uint32_t *) (sq + params.sq_off.ring_mask);
+  ring->sq_array = (uint32_t *) (sq + params.sq_off.array);
+  ring->cq_head = (uint32_t *) (cq + params.cq_off.head);
+  ring->cq_tail = (uint32_t *) (cq + params.cq_off.tail);
+  ring->cq_mask = (uint32_t *) (cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    queue_llz_uring
+
+ - Purpose:     Put a read in the submission queue.  It isn't sent to
+                the kernel until the next enter_llz_uring.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ring           =    The ring
+                - slot           =    The slots
+                - s              =    The slot number
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void queue_llz_uring (LLZ_URING *ring, LLZ_ASYNC_SLOT *slot, int32_t s)
+{
+  struct io_uring_sqe *sqe;
+  uint32_t tail, index;
+
+
+  tail = *ring->sq_tail;
+  index = tail & *ring->sq_mask;
+  sqe = &ring->sqes[index];
+
+  ring->iov[s].iov_base = slot[s].buffer;
+  ring->iov[s].iov_len = slot[s].size;
+
+
+  /*  IORING_OP_READV works on every kernel that has io_uring.  */
+
+  memset (sqe, 0, sizeof (struct io_uring_sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fileno (slot[s].llz->fp);
+  sqe->off = (uint64_t) slot[s].pos;
+  sqe->addr = (uint64_t) (uintptr_t) &ring->iov[s];
+  sqe->len = 1;
+  sqe->user_data = (uint64_t) s;
+
+  ring->sq_array[index] = index;
+
+  __atomic_store_n (ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  ring->to_submit++;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    enter_llz_uring
+
+ - Purpose:     Submit the queued reads and wait for at least one to
+                complete.
+
+ - Date:        10/16/26
+
+ - Arguments:   ring           =    The ring
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+static uint8_t enter_llz_uring (LLZ_URING *ring)
+{
+  long ret;
+
+
+  do
+    {
+      ret = syscall (__NR_io_uring_enter, ring->fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    }
+  while (ret < 0 && errno == EINTR);
+
+  if (ret < 0) return (0);
+
+  ring->to_submit -= (uint32_t) ret < ring->to_submit ? (uint32_t) ret : ring->to_submit;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    run_llz_async_uring
+
+ - Purpose:     Do all of the reads with io_uring.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ring           =    The ring
+                - slot           =    The slots
+                - depth          =    Number of slots
+                - hnd            =    The file handles
+                - files          =    Number of file handles
+                - next           =    Next record to read from each file
+                - chunk_records  =    Records per uncompressed read
+                - callback       =    The caller's callback
+                - user_data      =    Passed to the callback
+
+ - Returns:
+                - The number of records delivered
+                - -1 on error
+
+********************************************************************/
+
+static int64_t run_llz_async_uring (LLZ_URING *ring, LLZ_ASYNC_SLOT *slot, int32_t depth, const int32_t *hnd, int32_t files,
+                                    int64_t *next, int32_t chunk_records, LLZ_ASYNC_CALLBACK callback, void *user_data)
+{
+  struct io_uring_cqe *cqe;
+  uint32_t head, tail;
+  int32_t i, s, file = 0, busy = 0, got;
+  int64_t total = 0;
+  uint8_t error = 0;
+
+
+  /*  Fill every slot, then refill each slot as soon as its records have been delivered.  */
+
+  for (s = 0 ; s < depth ; s++)
+    {
+      for (i = 0 ; i < files ; i++, file = (file + 1) % files)
+        {
+          if (next_llz_async_read (&slot[s], hnd[file], get_llz_handle (hnd[file]), &next[file], chunk_records))
+            {
+              file = (file + 1) % files;
+              queue_llz_uring (ring, slot, s);
+              busy++;
+              break;
+            }
+        }
+    }
+
+  while (busy)
+    {
+      /*  After an error we stop queueing reads but we have to keep reaping until every read that was sent to the
+          kernel has finished.  Otherwise the kernel could write into the slot buffers after we've freed them.  */
+
+      if (!enter_llz_uring (ring))
+        {
+          /*  Reads that were queued but never sent to the kernel aren't in flight so we can forget about them.  */
+
+          error = 1;
+          busy -= (int32_t) ring->to_submit;
+          ring->to_submit = 0;
+
+
+          /*  If we can't even wait for the reads that are in flight there's nothing safe left to do.  */
+
+          if (busy && !enter_llz_uring (ring))
+            {
+              ring->stuck = 1;
+              return (-1);
+            }
+        }
+
+      head = *ring->cq_head;
+      tail = __atomic_load_n (ring->cq_tail, __ATOMIC_ACQUIRE);
+
+      for ( ; head != tail ; head++)
+        {
+          cqe = &ring->cqes[head & *ring->cq_mask];
+          s = (int32_t) cqe->user_data;
+
+          if (cqe->res < 0)
+            {
+              slot[s].error = 1;
+            }
+          else
+            {
+              slot[s].done = (size_t) cqe->res;
+            }
+
+          __atomic_store_n (ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+          busy--;
+
+          if (error) continue;
+
+          if ((got = deliver_llz_async_read (&slot[s], callback, user_data)) < 0)
+            {
+              error = 1;
+              continue;
+            }
+
+          total += got;
+
+          for (i = 0 ; i < files ; i++, file = (file + 1) % files)
+            {
+              if (next_llz_async_read (&slot[s], hnd[file], get_llz_handle (hnd[file]), &next[file], chunk_records))
+                {
+                  file = (file + 1) % files;
+                  queue_llz_uring (ring, slot, s);
+                  busy++;
+                  break;
+                }
+            }
+        }
+    }
+
+  if (error) return (-1);
+
+  return (total);
+}
+
+#endif
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_async
+
+ - Purpose:     Read every record of one or more llz files with many
+                reads in flight at once and hand the decoded records to a
+                callback in batches.  The batches arrive in the order
+                that the reads complete, not in file order, so use the
+                handle and start record passed to the callback to find
+                out where they came from.  The callback is always called
+                from the calling thread and the records are only valid
+                until it returns.  Uses io_uring on Linux when the kernel
+                supports it and a pool of pread threads otherwise.
+                Nothing can be appended or updated on the handles until
+                this returns and files that are still being written
+                with create_llz_compressed can't be read this way.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handles
+                - files          =    Number of file handles
+                - depth          =    Maximum number of reads in flight
+                                      (0 for the default of 32)
+                - callback       =    Called with each batch of records
+                - user_data      =    Passed to the callback
+
+ - Returns:
+                - The number of records delivered
+                - -1 on error (some batches may have been delivered)
+
+********************************************************************/
+
+int64_t read_llz_async (const int32_t *hnd, int32_t files, int32_t depth, LLZ_ASYNC_CALLBACK callback, void *user_data)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  LLZ_ASYNC_SLOT *slot = NULL;
+  int64_t *next = NULL, total = -1;
+  int32_t i, s, chunk_records = 1, record_size = 0, block_records = 0;
+  size_t buffer_size;
+
+#ifdef LLZ_IO_URING
+  LLZ_URING ring;
+#endif
+
+
+  if (files <= 0 || callback == NULL) return (-1);
+
+  if (depth <= 0) depth = LLZ_ASYNC_DEPTH;
+  if (depth > LLZ_ASYNC_MAX_DEPTH) depth = LLZ_ASYNC_MAX_DEPTH;
+
+
+  /*  Size the slot buffers for the largest records (and compressed blocks) of any of the files.  */
+
+  for (i = 0 ; i < files ; i++)
+    {
+      if ((llz = get_llz_handle (hnd[i])) == NULL || (llz->compression && llz->compression->write)) return (-1);
+
+
+      /*  Make sure anything appended through stdio is on disk before we go around it.  */
+
+      if (llz->write) fflush (llz->fp);
+
+      if (llz->layout.record_size > record_size) record_size = llz->layout.record_size;
+      if (llz->compression && llz->block_records > block_records) block_records = llz->block_records;
+    }
+
+  chunk_records = LLZ_ASYNC_BYTES / record_size;
+
+  buffer_size = (size_t) chunk_records * record_size;
+  if (LLZ_COMPRESS_BOUND (block_records) > buffer_size) buffer_size = LLZ_COMPRESS_BOUND (block_records);
+
+  if (block_records > chunk_records) chunk_records = block_records;
+
+  if ((next = (int64_t *) calloc (files, sizeof (int64_t))) == NULL ||
+      (slot = (LLZ_ASYNC_SLOT *) calloc (depth, sizeof (LLZ_ASYNC_SLOT))) == NULL) goto done;
+
+  for (s = 0 ; s < depth ; s++)
+    {
+      if ((slot[s].buffer = (uint8_t *) malloc (buffer_size)) == NULL ||
+          (slot[s].data = (LLZ_REC *) malloc ((size_t) chunk_records * sizeof (LLZ_REC))) == NULL) goto done;
+
+      if (block_records && (slot[s].rec = (uint8_t *) malloc ((size_t) block_records * record_size)) == NULL) goto done;
+    }
+
+
+#ifdef LLZ_IO_URING
+
+  if (open_llz_uring (&ring, depth))
+    {
+      total = run_llz_async_uring (&ring, slot, depth, hnd, files, next, chunk_records, callback, user_data);
+
+
+      /*  If io_uring_enter failed with reads still in flight the kernel may yet write into the ring and the slot
+          buffers.  Leaking them is the only safe thing to do.  */
+
+      if (ring.stuck)
+        {
+          free (next);
+          return (-1);
+        }
+
+      close_llz_uring (&ring);
+
+      goto done;
+    }
+
+#endif
+
+  total = run_llz_async_pool (slot, depth, hnd, files, next, chunk_records, callback, user_data);
+
+
+ done:
+
+  if (slot)
+    {
+      for (s = 0 ; s < depth ; s++)
+        {
+          if (slot[s].buffer) free (slot[s].buffer);
+          if (slot[s].rec) free (slot[s].rec);
+          if (slot[s].data) free (slot[s].data);
+        }
+
+      free (slot);
+    }
+
+  if (next) free (next);
+
+  return (total);
+}
@@ -0,0 +1,1621 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+/*  Block compressed llz files.  The records are packed exactly as they would be in an uncompressed file (always
+    in native byte order) and then each block of block_records records is compressed on its own so that any record
+    can be read by decompressing just one block.  Each field is stored as a column that starts with a byte giving
+    its encoding.  The time, uncertainty, latitude, longitude, and depth columns are stored as bit packed
+    differences from the previous record's value, bit packed values, or differences zigzag encoded as variable
+    length integers (7 bits per byte), whichever is smallest.  Bit packed columns are split into runs of
+    LLZ_PACK_RUN values and each run is stored as its minimum followed by every value minus the minimum using the
+    fewest bits that hold the largest one, so a beam's depth that only varies by a few centimeters within a run
+    takes a few bits instead of a byte or two.  The status is run length encoded or stored as a table of the
+    different values followed by bit packed table indexes.  Files written with [COMPRESSION] = DELTA have no
+    encoding bytes (every column is varint differences and the status is run length encoded).  The compressed
+    blocks follow the ASCII header and are followed by a table of the file offsets of each block (plus the offset
+    of the end of the last block) stored as little endian 64 bit integers.  The varints, the bit packing, and the
+    table don't depend on the byte order of the system so compressed files are always read without swapping.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "llz_internal.h"
+
+
+/*  Number of values in each bit packed run of a column.  Each run has its own minimum and bit width so a jump in
+    the data (like a new second in tv_nsec) only widens the run it's in.  */
+
+#define LLZ_PACK_RUN 64
+
+
+/*  Column encodings of a PACKED block.  */
+
+#define LLZ_COLUMN_VARINT 0                 /*  Zigzag varint deltas (the only encoding in DELTA blocks)  */
+#define LLZ_COLUMN_DELTA 1                  /*  Bit packed deltas  */
+#define LLZ_COLUMN_VALUE 2                  /*  Bit packed values  */
+
+
+/*  Status encodings of a PACKED block.  */
+
+#define LLZ_STATUS_RUNS 0                   /*  Run length encoded (the only encoding in DELTA blocks)  */
+#define LLZ_STATUS_TABLE 1                  /*  Table of values and bit packed table indexes  */
+
+
+/*  Most different status values in a block that can be stored with LLZ_STATUS_TABLE.  */
+
+#define LLZ_STATUS_TABLE_SIZE 256
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    put_llz_varint
+
+ - Purpose:     Store a zigzag encoded difference as a variable length
+                integer.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ptr            =    Where to put it
+                - value          =    The signed difference
+
+ - Returns:     Pointer to the next byte
+
+********************************************************************/
+
+static inline uint8_t *put_llz_varint (uint8_t *ptr, int64_t value)
+{
+  uint64_t zigzag = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+
+
+  while (zigzag >= 0x80)
+    {
+      *ptr++ = (uint8_t) (zigzag | 0x80);
+      zigzag >>= 7;
+    }
+
+  *ptr++ = (uint8_t) zigzag;
+
+  return (ptr);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_varint
+
+ - Purpose:     Get a zigzag encoded difference stored by put_llz_varint.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ptr            =    Where to get it (advanced past it)
+                - end            =    End of the compressed data
+                - value          =    The signed difference
+
+ - Returns:
+                - 0 if the data is corrupt
+                - 1
+
+********************************************************************/
+
+static inline uint8_t get_llz_varint (const uint8_t **ptr, const uint8_t *end, int64_t *value)
+{
+  const uint8_t *p = *ptr;
+  uint64_t zigzag = 0;
+  int32_t shift;
+
+
+  /*  Most differences fit in a single byte.  */
+
+  if (p < end && *p < 0x80)
+    {
+      *value = (int64_t) (*p >> 1) ^ -(int64_t) (*p & 1);
+      *ptr = p + 1;
+
+      return (1);
+    }
+
+  for (shift = 0 ; shift < 64 && p < end ; shift += 7)
+    {
+      zigzag |= (uint64_t) (*p & 0x7f) << shift;
+
+      if (!(*p++ & 0x80))
+        {
+          *value = (int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1);
+          *ptr = p;
+
+          return (1);
+        }
+    }
+
+  return (0);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_varint_size
+
+ - Purpose:     Number of bytes that put_llz_varint uses to store a
+                difference.
+
+ - Date:        10/16/26
+
+ - Arguments:   value          =    The signed difference
+
+ - Returns:     The number of bytes
+
+********************************************************************/
+
+static inline size_t get_llz_varint_size (int64_t value)
+{
+  uint64_t zigzag = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+  size_t size = 1;
+
+
+  while (zigzag >= 0x80)
+    {
+      zigzag >>= 7;
+      size++;
+    }
+
+  return (size);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_bit_width
+
+ - Purpose:     Number of bits needed to store the values from 0 to
+                range.
+
+ - Date:        10/16/26
+
+ - Arguments:   range          =    The largest value
+
+ - Returns:     The number of bits (0 to 32)
+
+********************************************************************/
+
+static inline int32_t get_llz_bit_width (uint32_t range)
+{
+  int32_t width = 0;
+
+
+  while (range)
+    {
+      width++;
+      range >>= 1;
+    }
+
+  return (width);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pack_llz_bits
+
+ - Purpose:     Store values using width bits each, least significant
+                bit first, in (count * width + 7) / 8 bytes.  The bytes
+                don't depend on the byte order of the system.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ptr            =    Where to put them
+                - value          =    The values (each less than
+                                      2 ** width)
+                - count          =    Number of values
+                - width          =    Bits per value (0 to 32)
+
+ - Returns:     Pointer to the next byte
+
+********************************************************************/
+
+static uint8_t *pack_llz_bits (uint8_t *ptr, const uint32_t *value, int32_t count, int32_t width)
+{
+  uint64_t bits = 0;
+  int32_t i, used = 0;
+
+
+  if (!width) return (ptr);
+
+  for (i = 0 ; i < count ; i++)
+    {
+      bits |= (uint64_t) value[i] << used;
+      used += width;
+
+      while (used >= 8)
+        {
+          *ptr++ = (uint8_t) bits;
+          bits >>= 8;
+          used -= 8;
+        }
+    }
+
+  if (used) *ptr++ = (uint8_t) bits;
+
+  return (ptr);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_le64
+
+ - Purpose:     Get 8 bytes as a little endian 64 bit integer (the
+                compiler turns this into a single load on little endian
+                systems).
+
+ - Date:        10/16/26
+
+ - Arguments:   ptr            =    The bytes
+
+ - Returns:     The value
+
+********************************************************************/
+
+static inline uint64_t get_llz_le64 (const uint8_t *ptr)
+{
+  return ((uint64_t) ptr[0] | (uint64_t) ptr[1] << 8 | (uint64_t) ptr[2] << 16 | (uint64_t) ptr[3] << 24 |
+          (uint64_t) ptr[4] << 32 | (uint64_t) ptr[5] << 40 | (uint64_t) ptr[6] << 48 | (uint64_t) ptr[7] << 56);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    unpack_llz_bits
+
+ - Purpose:     Get values stored by pack_llz_bits and add base to each
+                of them.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ptr            =    Where to get them (advanced past
+                                      them)
+                - end            =    End of the compressed data
+                - base           =    Added to each value
+                - count          =    Number of values
+                - width          =    Bits per value
+                - value          =    The returned values
+
+ - Returns:
+                - 0 if the data is corrupt
+                - 1
+
+********************************************************************/
+
+static inline uint8_t unpack_llz_bits (const uint8_t **ptr, const uint8_t *end, uint32_t base, int32_t count, int32_t width,
+                                       uint32_t *value)
+{
+  const uint8_t *p = *ptr;
+  size_t size = ((size_t) count * width + 7) / 8;
+  uint64_t bits = 0;
+  uint32_t mask;
+  int32_t i, used = 0;
+  size_t bit;
+
+
+  if (width < 0 || width > 32 || (size_t) (end - p) < size) return (0);
+
+  if (!width)
+    {
+      for (i = 0 ; i < count ; i++) value[i] = base;
+    }
+  else if ((size_t) (end - p) >= size + 8)
+    {
+      /*  When there are at least 8 more bytes in the block each value can be taken from a single 64 bit load.  */
+
+      mask = (uint32_t) (((uint64_t) 1 << width) - 1);
+
+      for (i = 0, bit = 0 ; i < count ; i++, bit += width)
+        value[i] = base + ((uint32_t) (get_llz_le64 (p + (bit >> 3)) >> (bit & 7)) & mask);
+    }
+  else
+    {
+      mask = (uint32_t) (((uint64_t) 1 << width) - 1);
+
+      for (i = 0 ; i < count ; i++)
+        {
+          while (used < width)
+            {
+              bits |= (uint64_t) *p++ << used;
+              used += 8;
+            }
+
+          value[i] = base + ((uint32_t) bits & mask);
+          bits >>= width;
+          used -= width;
+        }
+    }
+
+  *ptr += size;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_fields
+
+ - Purpose:     List the offsets of the 32 bit fields of a packed record
+                that are stored as columns.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - offset         =    The returned offsets (room for 6)
+
+ - Returns:     The number of fields
+
+********************************************************************/
+
+static int32_t get_llz_fields (const LLZ_LAYOUT *layout, int32_t *offset)
+{
+  int32_t fields = 0;
+
+
+  if (layout->time_offset >= 0)
+    {
+      offset[fields++] = layout->time_offset;
+      offset[fields++] = layout->time_offset + sizeof (int32_t);
+    }
+
+  if (layout->uncertainty_offset >= 0) offset[fields++] = layout->uncertainty_offset;
+
+  offset[fields++] = layout->lat_offset;
+  offset[fields++] = layout->lat_offset + sizeof (int32_t);
+  offset[fields++] = layout->lat_offset + 2 * sizeof (int32_t);
+
+  return (fields);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_packed_status
+
+ - Purpose:     Get the status from a native byte order packed record.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - rec            =    The packed record
+
+ - Returns:     The status
+
+********************************************************************/
+
+static inline uint32_t get_llz_packed_status (const LLZ_LAYOUT *layout, const uint8_t *rec)
+{
+  uint32_t stat32;
+  uint16_t stat16;
+
+
+  if (layout->stat_size == sizeof (uint32_t))
+    {
+      memcpy (&stat32, rec + layout->stat_offset, sizeof (uint32_t));
+      return (stat32);
+    }
+
+  memcpy (&stat16, rec + layout->stat_offset, sizeof (uint16_t));
+
+  return ((uint32_t) stat16);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    put_llz_packed_status
+
+ - Purpose:     Set the status of a native byte order packed record.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - rec            =    The packed record
+                - status         =    The status
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static inline void put_llz_packed_status (const LLZ_LAYOUT *layout, uint8_t *rec, uint32_t status)
+{
+  uint16_t stat16 = (uint16_t) status;
+
+
+  if (layout->stat_size == sizeof (uint32_t))
+    {
+      memcpy (rec + layout->stat_offset, &status, sizeof (uint32_t));
+    }
+  else
+    {
+      memcpy (rec + layout->stat_offset, &stat16, sizeof (uint16_t));
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pack_llz_column
+
+ - Purpose:     Store one 32 bit field of a block of records using the
+                given column encoding or just work out how big it would
+                be.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - rec            =    The packed records
+                - offset         =    Offset of the field in a record
+                - count          =    Number of records
+                - encoding       =    LLZ_COLUMN_VARINT, LLZ_COLUMN_DELTA,
+                                      or LLZ_COLUMN_VALUE
+                - out            =    Where to put the column or NULL to
+                                      only get the size
+
+ - Returns:     The size of the column
+
+********************************************************************/
+
+static size_t pack_llz_column (const LLZ_LAYOUT *layout, const uint8_t *rec, int32_t offset, int32_t count, int32_t encoding,
+                               uint8_t *out)
+{
+  uint32_t run[LLZ_PACK_RUN];
+  int32_t i, j, n, width, first = 0, value, prev = 0, min = 0, max = 0;
+  const uint8_t *ptr = rec + offset;
+  uint8_t *p = out;
+  size_t size = 0;
+
+
+  if (encoding == LLZ_COLUMN_VARINT)
+    {
+      for (i = 0 ; i < count ; i++, ptr += layout->record_size)
+        {
+          memcpy (&value, ptr, sizeof (int32_t));
+
+          size += get_llz_varint_size ((int64_t) value - prev);
+          if (out) p = put_llz_varint (p, (int64_t) value - prev);
+
+          prev = value;
+        }
+
+      return (size);
+    }
+
+
+  /*  Bit packed deltas start with the first value as a varint.  */
+
+  if (encoding == LLZ_COLUMN_DELTA && count)
+    {
+      memcpy (&prev, ptr, sizeof (int32_t));
+
+      size += get_llz_varint_size ((int64_t) prev);
+      if (out) p = put_llz_varint (p, (int64_t) prev);
+
+      first = 1;
+    }
+
+
+  /*  Each run is stored as its minimum (as a varint), the bit width, and the bit packed differences from the
+      minimum.  The deltas wrap around at 32 bits so they always fit in 32 bits.  */
+
+  for (i = first ; i < count ; i += n)
+    {
+      n = count - i;
+      if (n > LLZ_PACK_RUN) n = LLZ_PACK_RUN;
+
+      for (j = 0 ; j < n ; j++)
+        {
+          memcpy (&value, ptr + (size_t) (i + j) * layout->record_size, sizeof (int32_t));
+
+          if (encoding == LLZ_COLUMN_DELTA)
+            {
+              run[j] = (uint32_t) value - (uint32_t) prev;
+              prev = value;
+            }
+          else
+            {
+              run[j] = (uint32_t) value;
+            }
+
+          if (!j || (int32_t) run[j] < min) min = (int32_t) run[j];
+          if (!j || (int32_t) run[j] > max) max = (int32_t) run[j];
+        }
+
+      width = get_llz_bit_width ((uint32_t) max - (uint32_t) min);
+
+      size += get_llz_varint_size ((int64_t) min) + 1 + ((size_t) n * width + 7) / 8;
+
+      if (out)
+        {
+          for (j = 0 ; j < n ; j++) run[j] -= (uint32_t) min;
+
+          p = put_llz_varint (p, (int64_t) min);
+          *p++ = (uint8_t) width;
+          p = pack_llz_bits (p, run, n, width);
+        }
+    }
+
+  return (size);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pack_llz_status
+
+ - Purpose:     Store the status of a block of records using the given
+                status encoding or just work out how big it would be.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - rec            =    The packed records
+                - count          =    Number of records
+                - encoding       =    LLZ_STATUS_RUNS or LLZ_STATUS_TABLE
+                - out            =    Where to put the status or NULL to
+                                      only get the size
+
+ - Returns:
+                - The size of the status
+                - 0 if there are too many different status values for
+                  LLZ_STATUS_TABLE
+
+********************************************************************/
+
+static size_t pack_llz_status (const LLZ_LAYOUT *layout, const uint8_t *rec, int32_t count, int32_t encoding, uint8_t *out)
+{
+  uint32_t table[LLZ_STATUS_TABLE_SIZE], run[LLZ_PACK_RUN], status;
+  int32_t i, j, k, n, width, entries = 0, last = 0;
+  uint8_t *p = out;
+  size_t size = 0;
+
+
+  /*  Status runs are stored as the status followed by the run length.  */
+
+  if (encoding == LLZ_STATUS_RUNS)
+    {
+      for (i = 0 ; i < count ; i += n)
+        {
+          status = get_llz_packed_status (layout, rec + (size_t) i * layout->record_size);
+
+          for (n = 1 ; i + n < count ; n++)
+            {
+              if (get_llz_packed_status (layout, rec + (size_t) (i + n) * layout->record_size) != status) break;
+            }
+
+          size += get_llz_varint_size ((int64_t) status) + get_llz_varint_size ((int64_t) n);
+
+          if (out)
+            {
+              p = put_llz_varint (p, (int64_t) status);
+              p = put_llz_varint (p, (int64_t) n);
+            }
+        }
+
+      return (size);
+    }
+
+
+  /*  A table of the different status values followed by the bit packed table index of each record.  */
+
+  for (i = 0 ; i < count ; i++)
+    {
+      status = get_llz_packed_status (layout, rec + (size_t) i * layout->record_size);
+
+      if (entries && table[last] == status) continue;
+
+      for (k = 0 ; k < entries ; k++) if (table[k] == status) break;
+
+      if (k == entries)
+        {
+          if (entries == LLZ_STATUS_TABLE_SIZE) return (0);
+
+          table[entries++] = status;
+        }
+
+      last = k;
+    }
+
+  width = get_llz_bit_width ((uint32_t) entries - 1);
+
+  size = get_llz_varint_size ((int64_t) entries);
+  for (k = 0 ; k < entries ; k++) size += get_llz_varint_size ((int64_t) table[k]);
+
+  if (out)
+    {
+      p = put_llz_varint (p, (int64_t) entries);
+      for (k = 0 ; k < entries ; k++) p = put_llz_varint (p, (int64_t) table[k]);
+    }
+
+
+  /*  The indexes are packed in runs of LLZ_PACK_RUN so that they can be unpacked into a small buffer.  */
+
+  for (i = 0 ; i < count ; i += n)
+    {
+      n = count - i;
+      if (n > LLZ_PACK_RUN) n = LLZ_PACK_RUN;
+
+      size += ((size_t) n * width + 7) / 8;
+
+      if (out)
+        {
+          for (j = 0 ; j < n ; j++)
+            {
+              status = get_llz_packed_status (layout, rec + (size_t) (i + j) * layout->record_size);
+
+              if (table[last] != status)
+                {
+                  for (last = 0 ; table[last] != status ; last++);
+                }
+
+              run[j] = (uint32_t) last;
+            }
+
+          p = pack_llz_bits (p, run, n, width);
+        }
+    }
+
+  return (size);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    compress_llz_block
+
+ - Purpose:     Compress a block of native byte order packed records.
+                Each column is stored with whichever encoding makes it
+                smallest.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - rec            =    The packed records
+                - count          =    Number of records
+                - out            =    The compressed block (room for
+                                      LLZ_COMPRESS_BOUND (count) bytes)
+
+ - Returns:     The size of the compressed block
+
+********************************************************************/
+
+static size_t compress_llz_block (const LLZ_LAYOUT *layout, const uint8_t *rec, int32_t count, uint8_t *out)
+{
+  int32_t offset[6], fields, f, encoding, best;
+  size_t size, best_size;
+  uint8_t *p = out;
+
+
+  fields = get_llz_fields (layout, offset);
+
+  for (f = 0 ; f < fields ; f++)
+    {
+      best = LLZ_COLUMN_VARINT;
+      best_size = pack_llz_column (layout, rec, offset[f], count, LLZ_COLUMN_VARINT, NULL);
+
+      for (encoding = LLZ_COLUMN_DELTA ; encoding <= LLZ_COLUMN_VALUE ; encoding++)
+        {
+          size = pack_llz_column (layout, rec, offset[f], count, encoding, NULL);
+
+          if (size < best_size)
+            {
+              best = encoding;
+              best_size = size;
+            }
+        }
+
+      *p++ = (uint8_t) best;
+      p += pack_llz_column (layout, rec, offset[f], count, best, p);
+    }
+
+
+  best = LLZ_STATUS_RUNS;
+  best_size = pack_llz_status (layout, rec, count, LLZ_STATUS_RUNS, NULL);
+
+  size = pack_llz_status (layout, rec, count, LLZ_STATUS_TABLE, NULL);
+
+  if (size && size < best_size) best = LLZ_STATUS_TABLE;
+
+  *p++ = (uint8_t) best;
+  p += pack_llz_status (layout, rec, count, best, p);
+
+  return ((size_t) (p - out));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    unpack_llz_column
+
+ - Purpose:     Get one 32 bit field of a block of records stored by
+                pack_llz_column.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - ptr            =    Where to get it (advanced past it)
+                - end            =    End of the compressed block
+                - encoding       =    The column encoding
+                - count          =    Number of records
+                - rec            =    The field in the first packed
+                                      record
+
+ - Returns:
+                - 0 if the block is corrupt
+                - 1
+
+********************************************************************/
+
+static uint8_t unpack_llz_column (const LLZ_LAYOUT *layout, const uint8_t **ptr, const uint8_t *end, int32_t encoding,
+                                  int32_t count, uint8_t *rec)
+{
+  uint32_t run[LLZ_PACK_RUN], sum = 0;
+  int32_t i, j, n, width, value = 0, first = 0;
+  int64_t delta, min;
+  const uint8_t *p = *ptr;
+  uint8_t *out = rec;
+
+
+  switch (encoding)
+    {
+    case LLZ_COLUMN_VARINT:
+      for (i = 0 ; i < count ; i++, out += layout->record_size)
+        {
+          if (!get_llz_varint (&p, end, &delta)) return (0);
+
+          value = (int32_t) ((int64_t) value + delta);
+          memcpy (out, &value, sizeof (int32_t));
+        }
+      break;
+
+    case LLZ_COLUMN_DELTA:
+    case LLZ_COLUMN_VALUE:
+      if (encoding == LLZ_COLUMN_DELTA && count)
+        {
+          if (!get_llz_varint (&p, end, &delta)) return (0);
+
+          sum = (uint32_t) delta;
+          memcpy (out, &sum, sizeof (uint32_t));
+
+          first = 1;
+        }
+
+      for (i = first ; i < count ; i += n)
+        {
+          n = count - i;
+          if (n > LLZ_PACK_RUN) n = LLZ_PACK_RUN;
+
+          if (!get_llz_varint (&p, end, &min) || p >= end) return (0);
+
+          width = *p++;
+
+          if (!unpack_llz_bits (&p, end, (uint32_t) min, n, width, run)) return (0);
+
+          out = rec + (size_t) i * layout->record_size;
+
+          if (encoding == LLZ_COLUMN_DELTA)
+            {
+              for (j = 0 ; j < n ; j++, out += layout->record_size)
+                {
+                  sum += run[j];
+                  memcpy (out, &sum, sizeof (uint32_t));
+                }
+            }
+          else
+            {
+              for (j = 0 ; j < n ; j++, out += layout->record_size) memcpy (out, &run[j], sizeof (uint32_t));
+            }
+        }
+      break;
+
+    default:
+      return (0);
+    }
+
+  *ptr = p;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    unpack_llz_status
+
+ - Purpose:     Get the status of a block of records stored by
+                pack_llz_status.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - ptr            =    Where to get it (advanced past it)
+                - end            =    End of the compressed block
+                - encoding       =    The status encoding
+                - count          =    Number of records
+                - rec            =    The packed records
+
+ - Returns:
+                - 0 if the block is corrupt
+                - 1
+
+********************************************************************/
+
+static uint8_t unpack_llz_status (const LLZ_LAYOUT *layout, const uint8_t **ptr, const uint8_t *end, int32_t encoding,
+                                  int32_t count, uint8_t *rec)
+{
+  uint32_t table[LLZ_STATUS_TABLE_SIZE], run[LLZ_PACK_RUN];
+  int32_t i, j, n, width;
+  int64_t status, length, entries;
+  const uint8_t *p = *ptr;
+  uint8_t *out;
+
+
+  switch (encoding)
+    {
+    case LLZ_STATUS_RUNS:
+      for (i = 0 ; i < count ; i += (int32_t) length)
+        {
+          if (!get_llz_varint (&p, end, &status) || !get_llz_varint (&p, end, &length) || length <= 0 || length > count - i)
+            return (0);
+
+          for (j = 0, out = rec + (size_t) i * layout->record_size ; j < length ; j++, out += layout->record_size)
+            put_llz_packed_status (layout, out, (uint32_t) status);
+        }
+      break;
+
+    case LLZ_STATUS_TABLE:
+      if (!get_llz_varint (&p, end, &entries) || entries <= 0 || entries > LLZ_STATUS_TABLE_SIZE) return (0);
+
+      for (j = 0 ; j < entries ; j++)
+        {
+          if (!get_llz_varint (&p, end, &status)) return (0);
+
+          table[j] = (uint32_t) status;
+        }
+
+      width = get_llz_bit_width ((uint32_t) entries - 1);
+
+      for (i = 0 ; i < count ; i += n)
+        {
+          n = count - i;
+          if (n > LLZ_PACK_RUN) n = LLZ_PACK_RUN;
+
+          if (!unpack_llz_bits (&p, end, 0, n, width, run)) return (0);
+
+          for (j = 0, out = rec + (size_t) i * layout->record_size ; j < n ; j++, out += layout->record_size)
+            {
+              if (run[j] >= (uint32_t) entries) return (0);
+
+              put_llz_packed_status (layout, out, table[run[j]]);
+            }
+        }
+      break;
+
+    default:
+      return (0);
+    }
+
+  *ptr = p;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    expand_llz_block
+
+ - Purpose:     Decompress a block into native byte order packed
+                records.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - format         =    LLZ_COMPRESSION_DELTA or
+                                      LLZ_COMPRESSION_PACKED
+                - in             =    The compressed block
+                - size           =    Size of the compressed block
+                - count          =    Number of records in the block
+                - rec            =    The packed records
+
+ - Returns:
+                - 0 if the block is corrupt
+                - 1
+
+********************************************************************/
+
+static uint8_t expand_llz_block (const LLZ_LAYOUT *layout, uint8_t format, const uint8_t *in, size_t size, int32_t count,
+                                 uint8_t *rec)
+{
+  int32_t offset[6], fields, f, encoding;
+  const uint8_t *p = in, *end = in + size;
+
+
+  /*  DELTA blocks have no encoding bytes.  Every column is varint deltas and the status is run length
+      encoded.  */
+
+  fields = get_llz_fields (layout, offset);
+
+  for (f = 0 ; f < fields ; f++)
+    {
+      encoding = LLZ_COLUMN_VARINT;
+
+      if (format == LLZ_COMPRESSION_PACKED)
+        {
+          if (p >= end) return (0);
+          encoding = *p++;
+        }
+
+      if (!unpack_llz_column (layout, &p, end, encoding, count, rec + offset[f])) return (0);
+    }
+
+  encoding = LLZ_STATUS_RUNS;
+
+  if (format == LLZ_COMPRESSION_PACKED)
+    {
+      if (p >= end) return (0);
+      encoding = *p++;
+    }
+
+  return (unpack_llz_status (layout, &p, end, encoding, count, rec));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_block_count
+
+ - Purpose:     Number of records in a compressed block.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - block          =    The block number
+
+ - Returns:     The number of records
+
+********************************************************************/
+
+static int32_t get_llz_block_count (const INTERNAL_LLZ_HEADER *llz, int64_t block)
+{
+  int64_t count = llz->number_of_records64 - block * llz->block_records;
+
+
+  if (count > llz->block_records) count = llz->block_records;
+
+  return ((int32_t) count);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    load_llz_block
+
+ - Purpose:     Read and decompress one block from the file.  This
+                doesn't touch the handle's cache or FILE position so it
+                is safe to call from multiple threads.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - block          =    The block number
+                - packed         =    Buffer for the compressed block
+                                      (room for LLZ_COMPRESS_BOUND
+                                      (block_records) bytes)
+                - rec            =    The packed records
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+static uint8_t load_llz_block (const INTERNAL_LLZ_HEADER *llz, int64_t block, uint8_t *packed, uint8_t *rec)
+{
+  LLZ_COMPRESSION *compression = llz->compression;
+  size_t size;
+
+
+  size = (size_t) (compression->offset[block + 1] - compression->offset[block]);
+
+  if (pread_llz_bytes (llz, compression->offset[block], size, packed) != size) return (0);
+
+  return (expand_llz_block (&llz->layout, llz->compressed, packed, size, get_llz_block_count (llz, block), rec));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    decompress_llz_block
+
+ - Purpose:     Decompress a block that the caller has already read from
+                the file (e.g. with asynchronous I/O).
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - block          =    The block number
+                - packed         =    The compressed block (from
+                                      offset[block] to offset[block + 1])
+                - rec            =    The packed records
+
+ - Returns:
+                - The number of records in the block
+                - 0 if the block is corrupt
+
+********************************************************************/
+
+int32_t decompress_llz_block (const INTERNAL_LLZ_HEADER *llz, int64_t block, const uint8_t *packed, uint8_t *rec)
+{
+  LLZ_COMPRESSION *compression = llz->compression;
+  int32_t count = get_llz_block_count (llz, block);
+
+
+  if (!expand_llz_block (&llz->layout, llz->compressed, packed, (size_t) (compression->offset[block + 1] - compression->offset[block]),
+                         count, rec))
+    return (0);
+
+  return (count);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    allocate_llz_compression
+
+ - Purpose:     Allocate the compression state and buffers for a handle.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - table          =    Number of block table entries to
+                                      allocate
+
+ - Returns:
+                - 0 on allocation failure
+                - 1
+
+********************************************************************/
+
+static uint8_t allocate_llz_compression (INTERNAL_LLZ_HEADER *llz, int64_t table)
+{
+  LLZ_COMPRESSION *compression;
+
+
+  if ((compression = (LLZ_COMPRESSION *) calloc (1, sizeof (LLZ_COMPRESSION))) == NULL) return (0);
+
+  llz->compression = compression;
+
+  compression->cached_block = -1;
+  compression->table_size = table;
+
+  if ((compression->offset = (int64_t *) malloc ((size_t) table * sizeof (int64_t))) == NULL ||
+      (compression->block = (uint8_t *) malloc ((size_t) llz->block_records * llz->layout.record_size)) == NULL ||
+      (compression->packed = (uint8_t *) malloc (LLZ_COMPRESS_BOUND (llz->block_records))) == NULL) return (0);
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    free_llz_compression
+
+ - Purpose:     Free the compression state of a handle.
+
+ - Date:        10/16/26
+
+ - Arguments:   compression    =    The compression state
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void free_llz_compression (LLZ_COMPRESSION *compression)
+{
+  if (compression->offset) free (compression->offset);
+  if (compression->block) free (compression->block);
+  if (compression->pending) free (compression->pending);
+  if (compression->packed) free (compression->packed);
+
+  free (compression);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    open_llz_compression
+
+ - Purpose:     Set up a handle for reading a compressed llz file.  This
+                reads the block offset table.
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:
+                - 0 if the file is corrupt or on allocation failure
+                - 1
+
+********************************************************************/
+
+uint8_t open_llz_compression (INTERNAL_LLZ_HEADER *llz)
+{
+  LLZ_COMPRESSION *compression;
+  uint8_t *table;
+  int64_t i, j;
+  uint64_t offset;
+  size_t size;
+
+
+  if (llz->block_records <= 0 || llz->number_of_records64 < 0 || llz->block_table < LLZ_HEADER_SIZE) return (0);
+
+  if (!allocate_llz_compression (llz, (llz->number_of_records64 + llz->block_records - 1) / llz->block_records + 1))
+    return (0);
+
+  compression = llz->compression;
+  compression->blocks = compression->table_size - 1;
+
+
+  /*  Read the table and make sure that the blocks are in order and end at the table.  */
+
+  size = (size_t) compression->table_size * sizeof (int64_t);
+
+  if ((table = (uint8_t *) malloc (size)) == NULL) return (0);
+
+  if (pread_llz_bytes (llz, llz->block_table, size, table) != size)
+    {
+      free (table);
+      return (0);
+    }
+
+  for (i = 0 ; i < compression->table_size ; i++)
+    {
+      for (j = 7, offset = 0 ; j >= 0 ; j--) offset = (offset << 8) | table[i * 8 + j];
+
+      compression->offset[i] = (int64_t) offset;
+
+      if ((!i && compression->offset[i] != LLZ_HEADER_SIZE) || (i && (compression->offset[i] < compression->offset[i - 1] ||
+          compression->offset[i] - compression->offset[i - 1] > (int64_t) LLZ_COMPRESS_BOUND (llz->block_records))))
+        {
+          free (table);
+          return (0);
+        }
+    }
+
+  free (table);
+
+  if (compression->offset[compression->blocks] != llz->block_table) return (0);
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    start_llz_compression
+
+ - Purpose:     Set up a handle for writing a new compressed llz file.
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:
+                - 0 on allocation failure
+                - 1
+
+********************************************************************/
+
+uint8_t start_llz_compression (INTERNAL_LLZ_HEADER *llz)
+{
+  if (!allocate_llz_compression (llz, 1024)) return (0);
+
+  if ((llz->compression->pending = (uint8_t *) malloc ((size_t) llz->block_records * llz->layout.record_size)) == NULL) return (0);
+
+  llz->compression->offset[0] = LLZ_HEADER_SIZE;
+  llz->compression->write = 1;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    flush_llz_compression
+
+ - Purpose:     Compress the pending records and write them to the end
+                of the file as the next block.
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+static uint8_t flush_llz_compression (INTERNAL_LLZ_HEADER *llz)
+{
+  LLZ_COMPRESSION *compression = llz->compression;
+  int64_t *new_offset;
+  size_t size;
+
+
+  if (!compression->pending_count) return (1);
+
+
+  /*  Make room in the table for the end of this block.  */
+
+  if (compression->blocks + 2 > compression->table_size)
+    {
+      if ((new_offset = (int64_t *) realloc (compression->offset, (size_t) compression->table_size * 2 * sizeof (int64_t))) == NULL)
+        return (0);
+
+      compression->offset = new_offset;
+      compression->table_size *= 2;
+    }
+
+  size = compress_llz_block (&llz->layout, compression->pending, compression->pending_count, compression->packed);
+
+
+  /*  Flush so that pread sees the block.  */
+
+  fseeko64 (llz->fp, compression->offset[compression->blocks], SEEK_SET);
+
+  if (fwrite (compression->packed, 1, size, llz->fp) != size || fflush (llz->fp)) return (0);
+
+  compression->offset[compression->blocks + 1] = compression->offset[compression->blocks] + (int64_t) size;
+  compression->blocks++;
+  compression->pending_count = 0;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    append_llz_compressed
+
+ - Purpose:     Add records to the end of a compressed llz file.  The
+                records are held until there is a full block to
+                compress.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - data           =    The llz records
+                - count          =    Number of records
+
+ - Returns:     The number of records appended
+
+********************************************************************/
+
+int32_t append_llz_compressed (INTERNAL_LLZ_HEADER *llz, const LLZ_REC *data, int32_t count)
+{
+  LLZ_COMPRESSION *compression = llz->compression;
+  int32_t done, num;
+
+
+  if (!compression->write) return (0);
+
+  for (done = 0 ; done < count ; done += num)
+    {
+      num = llz->block_records - compression->pending_count;
+      if (num > count - done) num = count - done;
+
+      encode_llz_records (&llz->layout, 0, &data[done], num, compression->pending + (size_t) compression->pending_count *
+                          llz->layout.record_size);
+
+      add_llz_stats (llz, compression->pending + (size_t) compression->pending_count * llz->layout.record_size, num);
+
+      compression->pending_count += num;
+      llz->number_of_records64 += num;
+
+      if (compression->pending_count == llz->block_records && !flush_llz_compression (llz))
+        {
+          /*  The block never made it to disk (and it's already in the header statistics).  */
+
+          llz->number_of_records64 -= compression->pending_count;
+          compression->pending_count = 0;
+
+          llz->stats_state = LLZ_STATS_UNKNOWN;
+
+          return (done);
+        }
+    }
+
+  return (done);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    finish_llz_compression
+
+ - Purpose:     Write the last (partial) block and the block offset
+                table.  This is called by close_llz before it writes the
+                header.
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+uint8_t finish_llz_compression (INTERNAL_LLZ_HEADER *llz)
+{
+  LLZ_COMPRESSION *compression = llz->compression;
+  uint8_t *table;
+  uint64_t offset;
+  int64_t i, j;
+  size_t size;
+
+
+  if (!compression->write) return (1);
+
+  if (!flush_llz_compression (llz))
+    {
+      llz->number_of_records64 -= compression->pending_count;
+      compression->pending_count = 0;
+
+      llz->stats_state = LLZ_STATS_UNKNOWN;
+    }
+
+
+  size = (size_t) (compression->blocks + 1) * sizeof (int64_t);
+
+  if ((table = (uint8_t *) malloc (size)) == NULL) return (0);
+
+  for (i = 0 ; i <= compression->blocks ; i++)
+    {
+      for (j = 0, offset = (uint64_t) compression->offset[i] ; j < 8 ; j++, offset >>= 8) table[i * 8 + j] = (uint8_t) offset;
+    }
+
+  llz->block_table = compression->offset[compression->blocks];
+
+  fseeko64 (llz->fp, llz->block_table, SEEK_SET);
+
+  i = (fwrite (table, 1, size, llz->fp) == size);
+
+  free (table);
+
+  compression->write = 0;
+
+  return ((uint8_t) i);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_compressed
+
+ - Purpose:     Get count packed records starting at record start from
+                a compressed llz file.  The last block that was
+                decompressed is kept so reading a file in order (or
+                reading nearby records) only decompresses each block
+                once.  Whole blocks are decompressed straight into buf.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - start          =    The first record
+                - count          =    Number of records (start + count
+                                      must not be past the end of the
+                                      file)
+                - buf            =    The returned packed records
+
+ - Returns:     The number of records (less than count on error)
+
+********************************************************************/
+
+int32_t read_llz_compressed (INTERNAL_LLZ_HEADER *llz, int64_t start, int32_t count, uint8_t *buf)
+{
+  LLZ_COMPRESSION *compression = llz->compression;
+  int64_t block;
+  int32_t done, first, num, size = llz->layout.record_size;
+  const uint8_t *rec;
+
+
+  for (done = 0 ; done < count ; done += num)
+    {
+      block = (start + done) / llz->block_records;
+      first = (int32_t) (start + done - block * llz->block_records);
+
+      num = get_llz_block_count (llz, block) - first;
+      if (num > count - done) num = count - done;
+
+
+      /*  Records that haven't been compressed yet.  */
+
+      if (block == compression->blocks)
+        {
+          if (first + num > compression->pending_count) break;
+
+          rec = compression->pending;
+        }
+      else if (block == compression->cached_block)
+        {
+          rec = compression->block;
+        }
+      else if (!first && num == llz->block_records)
+        {
+          if (!load_llz_block (llz, block, compression->packed, buf + (size_t) done * size)) break;
+
+          continue;
+        }
+      else
+        {
+          compression->cached_block = -1;
+
+          if (!load_llz_block (llz, block, compression->packed, compression->block)) break;
+
+          compression->cached_block = block;
+          rec = compression->block;
+        }
+
+      memcpy (buf + (size_t) done * size, rec + (size_t) first * size, (size_t) num * size);
+    }
+
+  return (done);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pread_llz_compressed
+
+ - Purpose:     Stateless version of read_llz_compressed for
+                pread_llz_range.  Every call uses its own buffers so any
+                number of threads can read the same handle.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - start          =    The first record
+                - count          =    Number of records (start + count
+                                      must not be past the end of the
+                                      file)
+                - buf            =    The returned packed records
+
+ - Returns:     The number of records (less than count on error)
+
+********************************************************************/
+
+int32_t pread_llz_compressed (const INTERNAL_LLZ_HEADER *llz, int64_t start, int32_t count, uint8_t *buf)
+{
+  LLZ_COMPRESSION *compression = llz->compression;
+  int64_t block;
+  int32_t done, first, num, size = llz->layout.record_size;
+  uint8_t *packed, *rec;
+
+
+  if ((packed = (uint8_t *) malloc (LLZ_COMPRESS_BOUND (llz->block_records))) == NULL) return (0);
+
+  if ((rec = (uint8_t *) malloc ((size_t) llz->block_records * size)) == NULL)
+    {
+      free (packed);
+      return (0);
+    }
+
+  for (done = 0 ; done < count ; done += num)
+    {
+      block = (start + done) / llz->block_records;
+      first = (int32_t) (start + done - block * llz->block_records);
+
+      num = get_llz_block_count (llz, block) - first;
+      if (num > count - done) num = count - done;
+
+      if (block == compression->blocks)
+        {
+          if (first + num > compression->pending_count) break;
+
+          memcpy (buf + (size_t) done * size, compression->pending + (size_t) first * size, (size_t) num * size);
+        }
+      else
+        {
+          if (!load_llz_block (llz, block, packed, rec)) break;
+
+          memcpy (buf + (size_t) done * size, rec + (size_t) first * size, (size_t) num * size);
+        }
+    }
+
+  free (packed);
+  free (rec);
+
+  return (done);
+}
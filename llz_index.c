@@ -0,0 +1,846 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Optional bounding box index for llz files.  The index is stored in a sidecar file named <llz file>.idx that has
+    a small ASCII header (in the same style as the llz header) followed by the bounding box of each block of
+    LLZ_INDEX_BLOCK_RECORDS records.  The index is tied to the llz file by the number of records and the last
+    modified date in the llz header.  Closing an llz handle that changed the file removes the index.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "llz_internal.h"
+#include "swap_bytes.h"
+#include "llz_version.h"
+
+
+#define LLZ_INDEX_HEADER_SIZE 1024
+
+
+int32_t big_endian ();
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_index_path
+
+ - Purpose:     Build the index sidecar file name for an llz file.
+
+ - Date:        10/16/26
+
+ - Arguments:   path           =    The llz file path
+
+ - Returns:
+                - The index path (free it when done) or NULL on error
+
+********************************************************************/
+
+static char *get_llz_index_path (const char *path)
+{
+  char *index_path;
+
+
+  if ((index_path = (char *) malloc (strlen (path) + 5)) == NULL) return (NULL);
+
+  strcpy (index_path, path);
+  strcat (index_path, ".idx");
+
+  return (index_path);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    trim_llz_date
+
+ - Purpose:     Copy a date string without leading or trailing blanks
+                so that dates can be compared no matter how many blanks
+                were left around them by writing and re-reading headers.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - date           =    The date string
+                - trimmed        =    The trimmed date (at least as big
+                                      as LLZ_HEADER.modified_date)
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void trim_llz_date (const char *date, char *trimmed)
+{
+  size_t length;
+
+
+  while (*date == ' ' || *date == '\t') date++;
+
+  length = strlen (date);
+  while (length && (date[length - 1] == ' ' || date[length - 1] == '\t')) length--;
+
+  memcpy (trimmed, date, length);
+  trimmed[length] = 0;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    free_llz_index
+
+ - Purpose:     Free a loaded bounding box index.
+
+ - Date:        10/16/26
+
+ - Arguments:   index          =    The index
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void free_llz_index (LLZ_INDEX *index)
+{
+  if (index->block) free (index->block);
+  free (index);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    remove_llz_index
+
+ - Purpose:     Delete the index sidecar file for an llz file (if there
+                is one).
+
+ - Date:        10/16/26
+
+ - Arguments:   path           =    The llz file path
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void remove_llz_index (const char *path)
+{
+  char *index_path;
+
+
+  if ((index_path = get_llz_index_path (path)) == NULL) return;
+
+  remove (index_path);
+
+  free (index_path);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    create_llz_index
+
+ - Purpose:     Build the bounding box index sidecar file for an llz
+                file.  The file must not be open for writing.  This reads
+                the whole file once and records the minimum and maximum
+                latitude, longitude, depth, and time of each block of
+                LLZ_INDEX_BLOCK_RECORDS records.  read_llz_bbox and
+                read_llz_time_range use the index to skip blocks that
+                can't contain any points in the area or time range of
+                interest.  The index has to be rebuilt after the
+                llz file is changed (closing a handle that changed the
+                file deletes it).
+
+ - Date:        10/16/26
+
+ - Arguments:   path           =    The llz file path
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+uint8_t create_llz_index (const char *path)
+{
+  LLZ_HEADER header;
+  LLZ_RAW raw;
+  LLZ_INDEX_BLOCK *block;
+  int64_t n, blocks, b, t, min_t, max_t, last_t;
+  int32_t hnd, i, num, expected, value, sec, nsec;
+  char *index_path, text[LLZ_INDEX_HEADER_SIZE], date[sizeof (header.modified_date)];
+  uint8_t monotonic;
+  FILE *fp;
+
+
+  if ((hnd = open_llz_mmap (path, &header)) < 0) return (0);
+
+  n = get_llz_record_count64 (hnd);
+  blocks = (n + LLZ_INDEX_BLOCK_RECORDS - 1) / LLZ_INDEX_BLOCK_RECORDS;
+
+  if ((block = (LLZ_INDEX_BLOCK *) calloc (blocks ? blocks : 1, sizeof (LLZ_INDEX_BLOCK))) == NULL)
+    {
+      close_llz (hnd);
+      return (0);
+    }
+
+
+  last_t = INT64_MIN;
+  monotonic = 1;
+
+  for (b = 0 ; b < blocks ; b++)
+    {
+      expected = LLZ_INDEX_BLOCK_RECORDS;
+      if (n - b * LLZ_INDEX_BLOCK_RECORDS < expected) expected = (int32_t) (n - b * LLZ_INDEX_BLOCK_RECORDS);
+
+      if ((num = read_llz_raw (hnd, b * LLZ_INDEX_BLOCK_RECORDS, expected, &raw)) != expected)
+        {
+          free (block);
+          close_llz (hnd);
+          return (0);
+        }
+
+      block[b].min_lat = block[b].min_lon = block[b].min_depth = INT32_MAX;
+      block[b].max_lat = block[b].max_lon = block[b].max_depth = INT32_MIN;
+      min_t = INT64_MAX;
+      max_t = INT64_MIN;
+
+      for (i = 0 ; i < num ; i++)
+        {
+          value = llz_raw_int32 (&raw, i, raw.lat_offset);
+          if (value < block[b].min_lat) block[b].min_lat = value;
+          if (value > block[b].max_lat) block[b].max_lat = value;
+
+          value = llz_raw_int32 (&raw, i, raw.lon_offset);
+          if (value < block[b].min_lon) block[b].min_lon = value;
+          if (value > block[b].max_lon) block[b].max_lon = value;
+
+          value = llz_raw_int32 (&raw, i, raw.depth_offset);
+          if (value < block[b].min_depth) block[b].min_depth = value;
+          if (value > block[b].max_depth) block[b].max_depth = value;
+
+
+          /*  Keep track of the time span of the block and whether the times ever go backwards.  */
+
+          if (raw.time_offset >= 0)
+            {
+              sec = llz_raw_int32 (&raw, i, raw.time_offset);
+              nsec = llz_raw_int32 (&raw, i, raw.time_offset + sizeof (int32_t));
+              t = (int64_t) sec * 1000000000 + nsec;
+
+              if (t < min_t)
+                {
+                  min_t = t;
+                  block[b].min_sec = sec;
+                  block[b].min_nsec = nsec;
+                }
+
+              if (t > max_t)
+                {
+                  max_t = t;
+                  block[b].max_sec = sec;
+                  block[b].max_nsec = nsec;
+                }
+
+              if (t < last_t) monotonic = 0;
+              last_t = t;
+            }
+        }
+    }
+
+  close_llz (hnd);
+
+  if (!blocks || raw.time_offset < 0) monotonic = 0;
+
+
+  /*  Write the index file.  */
+
+  if ((index_path = get_llz_index_path (path)) == NULL || (fp = fopen64 (index_path, "wb")) == NULL)
+    {
+      if (index_path) free (index_path);
+      free (block);
+      return (0);
+    }
+
+  trim_llz_date (header.modified_date, date);
+
+  memset (text, 0, LLZ_INDEX_HEADER_SIZE);
+
+  snprintf (text, LLZ_INDEX_HEADER_SIZE,
+            "[VERSION] = %s\n"
+            "[ENDIAN] = %s\n"
+            "[BLOCK RECORDS] = %d\n"
+            "[NUMBER OF BLOCKS] = %" PRId64 "\n"
+            "[NUMBER OF RECORDS] = %" PRId64 "\n"
+            "[LAST MODIFIED DATE] = %s\n"
+            "[BLOCK BYTES] = %d\n"
+            "[TIME MONOTONIC] = %d\n"
+            "[END OF HEADER]\n",
+            LLZ_VERSION,
+            big_endian () ? "BIG" : "LITTLE",
+            LLZ_INDEX_BLOCK_RECORDS,
+            blocks,
+            n,
+            date,
+            (int32_t) sizeof (LLZ_INDEX_BLOCK),
+            monotonic);
+
+  if (fwrite (text, LLZ_INDEX_HEADER_SIZE, 1, fp) != 1 || (blocks && fwrite (block, sizeof (LLZ_INDEX_BLOCK), blocks, fp) != (size_t) blocks))
+    {
+      fclose (fp);
+      remove (index_path);
+      free (index_path);
+      free (block);
+      return (0);
+    }
+
+  fclose (fp);
+  free (index_path);
+  free (block);
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    load_llz_index
+
+ - Purpose:     Load the bounding box index for an open llz file if
+                there is one and it matches the file.
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:
+                - The index or NULL if there isn't a usable index
+
+********************************************************************/
+
+LLZ_INDEX *load_llz_index (const INTERNAL_LLZ_HEADER *llz)
+{
+  LLZ_INDEX *index;
+  FILE *fp;
+  char *index_path, *line, *next, *info, text[LLZ_INDEX_HEADER_SIZE + 1];
+  char date[sizeof (llz->header.modified_date)], index_date[sizeof (llz->header.modified_date)];
+  int64_t records, b;
+  int32_t i, *field, block_bytes, monotonic;
+  uint8_t swap;
+
+
+  if (llz->path == NULL || (index_path = get_llz_index_path (llz->path)) == NULL) return (NULL);
+
+  fp = fopen64 (index_path, "rb");
+
+  free (index_path);
+
+  if (fp == NULL) return (NULL);
+
+  if (fread (text, LLZ_INDEX_HEADER_SIZE, 1, fp) != 1 || (index = (LLZ_INDEX *) calloc (1, sizeof (LLZ_INDEX))) == NULL)
+    {
+      fclose (fp);
+      return (NULL);
+    }
+
+  text[LLZ_INDEX_HEADER_SIZE] = 0;
+
+
+  /*  The header is tiny so we just walk it a line at a time.  */
+
+  records = -1;
+  index_date[0] = 0;
+  swap = 0;
+  block_bytes = monotonic = 0;
+
+  for (line = text ; line && *line ; line = next)
+    {
+      if ((next = strchr (line, '\n')) != NULL) *next++ = 0;
+
+      if (strstr (line, "[END OF HEADER]")) break;
+
+      if ((info = strchr (line, '=')) == NULL) continue;
+      info++;
+
+      if (!strncmp (line, "[ENDIAN]", 8)) swap = (strstr (info, big_endian () ? "LITTLE" : "BIG") != NULL);
+
+      if (!strncmp (line, "[BLOCK RECORDS]", 15)) sscanf (info, "%d", &index->block_records);
+
+      if (!strncmp (line, "[NUMBER OF BLOCKS]", 18)) sscanf (info, "%" SCNd64, &index->blocks);
+
+      if (!strncmp (line, "[NUMBER OF RECORDS]", 19)) sscanf (info, "%" SCNd64, &records);
+
+      if (!strncmp (line, "[BLOCK BYTES]", 13)) sscanf (info, "%d", &block_bytes);
+
+      if (!strncmp (line, "[TIME MONOTONIC]", 16)) sscanf (info, "%d", &monotonic);
+
+      if (!strncmp (line, "[LAST MODIFIED DATE]", 20))
+        {
+          strncpy (date, info, sizeof (date) - 1);
+          date[sizeof (date) - 1] = 0;
+          trim_llz_date (date, index_date);
+        }
+    }
+
+
+  /*  Make sure the index goes with this version of the llz file.  */
+
+  trim_llz_date (llz->header.modified_date, date);
+
+  if (records != llz->number_of_records64 || strcmp (date, index_date) || index->block_records <= 0 ||
+      block_bytes != (int32_t) sizeof (LLZ_INDEX_BLOCK) ||
+      index->blocks != (records + index->block_records - 1) / index->block_records ||
+      (index->block = (LLZ_INDEX_BLOCK *) malloc ((index->blocks ? index->blocks : 1) * sizeof (LLZ_INDEX_BLOCK))) == NULL ||
+      (index->blocks && fread (index->block, sizeof (LLZ_INDEX_BLOCK), index->blocks, fp) != (size_t) index->blocks))
+    {
+      fclose (fp);
+      free_llz_index (index);
+      return (NULL);
+    }
+
+  fclose (fp);
+
+  index->time_monotonic = (monotonic == 1);
+
+
+  if (swap)
+    {
+      for (b = 0 ; b < index->blocks ; b++)
+        {
+          field = &index->block[b].min_lat;
+          for (i = 0 ; i < (int32_t) (sizeof (LLZ_INDEX_BLOCK) / sizeof (int32_t)) ; i++) swap_int (&field[i]);
+        }
+    }
+
+  return (index);
+}
+
+
+/*  What read_llz_query is looking for.  */
+
+typedef struct
+{
+  uint8_t       time;                 /*!<  Set for a time range, otherwise it's a bounding box  */
+  double        min_lat;
+  double        min_lon;
+  double        max_lat;
+  double        max_lon;
+  int64_t       start;                /*!<  Start time in nanoseconds from the epoch  */
+  int64_t       end;                  /*!<  End time in nanoseconds from the epoch  */
+} LLZ_QUERY;
+
+
+/*  Results of checking an index block against a query.  */
+
+#define LLZ_BLOCK_SKIP 0
+#define LLZ_BLOCK_READ 1
+#define LLZ_BLOCK_DONE 2
+
+
+/********************************************************************/
+/*!
+
+ - Function:    check_llz_block
+
+ - Purpose:     Decide whether a block of records might have anything
+                that matches a query.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - index          =    The index
+                - block          =    The block
+                - query          =    The query
+
+ - Returns:
+                - LLZ_BLOCK_SKIP if nothing in the block can match
+                - LLZ_BLOCK_READ if something in the block might match
+                - LLZ_BLOCK_DONE if nothing in this or any later block
+                  can match
+
+********************************************************************/
+
+static int32_t check_llz_block (const LLZ_INDEX *index, const LLZ_INDEX_BLOCK *block, const LLZ_QUERY *query)
+{
+  if (query->time)
+    {
+      if ((int64_t) block->min_sec * 1000000000 + block->min_nsec > query->end)
+        {
+          /*  If the times never go backwards every block after this one starts even later.  */
+
+          if (index->time_monotonic) return (LLZ_BLOCK_DONE);
+
+          return (LLZ_BLOCK_SKIP);
+        }
+
+      if ((int64_t) block->max_sec * 1000000000 + block->max_nsec < query->start) return (LLZ_BLOCK_SKIP);
+
+      return (LLZ_BLOCK_READ);
+    }
+
+  if (block->max_lat / 10000000.0 >= query->min_lat && block->min_lat / 10000000.0 <= query->max_lat &&
+      block->max_lon / 10000000.0 >= query->min_lon && block->min_lon / 10000000.0 <= query->max_lon) return (LLZ_BLOCK_READ);
+
+  return (LLZ_BLOCK_SKIP);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    find_llz_time_block
+
+ - Purpose:     Binary search the blocks of a time monotonic index for
+                the first block that ends at or after a start time.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - index          =    The index
+                - start          =    Start time in nanoseconds
+
+ - Returns:     The block number (index->blocks if there isn't one)
+
+********************************************************************/
+
+static int64_t find_llz_time_block (const LLZ_INDEX *index, int64_t start)
+{
+  int64_t low = 0, high = index->blocks, mid;
+
+
+  while (low < high)
+    {
+      mid = low + (high - low) / 2;
+
+      if ((int64_t) index->block[mid].max_sec * 1000000000 + index->block[mid].max_nsec < start)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  return (low);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_query
+
+ - Purpose:     Retrieve the llz records that match a query, using the
+                index (if there is one) to skip blocks of records that
+                can't match.  This does all of the work for read_llz_bbox
+                and read_llz_time_range.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - query          =    The query
+                - cursor         =    Next record to check
+                - recnums        =    The returned record numbers (may be
+                                      NULL)
+                - data           =    The returned llz records
+                - count          =    The maximum number of records to
+                                      return
+
+ - Returns:
+                - The number of records returned
+                - 0 when there are no more matching records or on error
+
+********************************************************************/
+
+static int32_t read_llz_query (int32_t hnd, const LLZ_QUERY *query, int64_t *cursor, int64_t *recnums, LLZ_REC *data, int32_t count)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  LLZ_INDEX *index;
+  LLZ_RAW raw;
+  int64_t rec, end, b, n, t;
+  int32_t i, num, found, check = LLZ_BLOCK_READ;
+  double lat, lon;
+  uint8_t match;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL || count <= 0 || *cursor < 0) return (0);
+
+
+  /*  Load the index the first time we need it.  If this handle has changed the file the index can't be trusted.  */
+
+  if (!llz->index_checked)
+    {
+      llz->index = load_llz_index (llz);
+      llz->index_checked = 1;
+    }
+
+  index = llz->modified ? NULL : llz->index;
+
+
+  n = llz->number_of_records64;
+  found = 0;
+
+
+  /*  If the times never go backwards we can go straight to the first block that might be in the time range.  */
+
+  if (index && query->time && index->time_monotonic)
+    {
+      b = find_llz_time_block (index, query->start);
+      if (b * index->block_records > *cursor) *cursor = b * index->block_records;
+    }
+
+  while (found < count && *cursor < n)
+    {
+      rec = *cursor;
+      end = rec + LLZ_INDEX_BLOCK_RECORDS;
+
+
+      /*  Skip the blocks that can't have anything we're looking for.  */
+
+      if (index)
+        {
+          for (b = rec / index->block_records ; b < index->blocks ; b++)
+            {
+              if ((check = check_llz_block (index, &index->block[b], query)) != LLZ_BLOCK_SKIP) break;
+            }
+
+          if (b == index->blocks || check == LLZ_BLOCK_DONE)
+            {
+              *cursor = n;
+              break;
+            }
+
+          if (b * index->block_records > rec) rec = b * index->block_records;
+          end = (b + 1) * index->block_records;
+        }
+
+      if (end > n) end = n;
+
+      if ((num = read_llz_raw (hnd, rec, (int32_t) (end - rec), &raw)) <= 0) break;
+
+      for (i = 0 ; i < num && found < count ; i++)
+        {
+          if (query->time)
+            {
+              t = (int64_t) llz_raw_tv_sec (&raw, i) * 1000000000 + llz_raw_tv_nsec (&raw, i);
+              match = (t >= query->start && t <= query->end);
+            }
+          else
+            {
+              lat = llz_raw_lat (&raw, i);
+              lon = llz_raw_lon (&raw, i);
+              match = (lat >= query->min_lat && lat <= query->max_lat && lon >= query->min_lon && lon <= query->max_lon);
+            }
+
+          if (match)
+            {
+              decode_llz_records (&llz->layout, llz->swap, raw.data + (size_t) i * raw.record_size, 1, &data[found]);
+              if (recnums) recnums[found] = rec + i;
+              found++;
+            }
+        }
+
+      *cursor = rec + i;
+    }
+
+  return (found);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_bbox
+
+ - Purpose:     Retrieve the llz records that fall inside a latitude and
+                longitude bounding box.  Call this repeatedly with the
+                same cursor until it returns 0.  If the file has a
+                bounding box index (see create_llz_index) blocks of
+                records that can't contain any points in the box are
+                skipped so the time taken is roughly proportional to the
+                number of points found instead of the size of the file.
+                Without an index every record is checked.  The box can't
+                cross the 180 degree meridian.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - min_lat        =    Southern boundary of the box
+                - min_lon        =    Western boundary of the box
+                - max_lat        =    Northern boundary of the box
+                - max_lon        =    Eastern boundary of the box
+                - cursor         =    Set to 0 before the first call, this
+                                      keeps track of where to continue
+                                      searching
+                - recnums        =    The returned record numbers (may be
+                                      NULL)
+                - data           =    The returned llz records
+                - count          =    The maximum number of records to
+                                      return
+
+ - Returns:
+                - The number of records returned
+                - 0 when there are no more records in the box or on error
+
+********************************************************************/
+
+int32_t read_llz_bbox (int32_t hnd, double min_lat, double min_lon, double max_lat, double max_lon, int64_t *cursor,
+                       int64_t *recnums, LLZ_REC *data, int32_t count)
+{
+  LLZ_QUERY query;
+
+
+  memset (&query, 0, sizeof (LLZ_QUERY));
+
+  query.min_lat = min_lat;
+  query.min_lon = min_lon;
+  query.max_lat = max_lat;
+  query.max_lon = max_lon;
+
+  return (read_llz_query (hnd, &query, cursor, recnums, data, count));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_query_time
+
+ - Purpose:     Convert a query time to nanoseconds.  The seconds are
+                clamped to the 32 bit range that is stored in the file
+                (so that huge values like LONG_MAX don't overflow) and the
+                nanoseconds are clamped to 0 to 999999999.  Clamped
+                seconds get the first or last nanosecond of the second so
+                the time stays on the same side of every record time.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - sec            =    POSIX seconds
+                - nsec           =    Nanoseconds
+
+ - Returns:     The time in nanoseconds
+
+********************************************************************/
+
+static int64_t get_llz_query_time (time_t sec, long nsec)
+{
+  if (sec < INT32_MIN)
+    {
+      sec = INT32_MIN;
+      nsec = 0;
+    }
+  else if (sec > INT32_MAX)
+    {
+      sec = INT32_MAX;
+      nsec = 999999999;
+    }
+
+  if (nsec < 0) nsec = 0;
+  if (nsec > 999999999) nsec = 999999999;
+
+  return ((int64_t) sec * 1000000000 + nsec);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_time_range
+
+ - Purpose:     Retrieve the llz records with times between start and
+                end (inclusive).  Call this repeatedly with the same
+                cursor until it returns 0.  If the file has an index (see
+                create_llz_index) blocks of records whose time span
+                doesn't overlap the range are skipped.  If the index shows
+                that the times never decrease (the usual case for data in
+                acquisition order) the first block is found with a binary
+                search and the search stops at the first block that starts
+                after the end time.  Without an index every record is
+                checked.  Files without time never match.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start_sec      =    Start time POSIX seconds
+                - start_nsec     =    Start time nanoseconds
+                - end_sec        =    End time POSIX seconds
+                - end_nsec       =    End time nanoseconds
+                - cursor         =    Set to 0 before the first call, this
+                                      keeps track of where to continue
+                                      searching
+                - recnums        =    The returned record numbers (may be
+                                      NULL)
+                - data           =    The returned llz records
+                - count          =    The maximum number of records to
+                                      return
+
+ - Returns:
+                - The number of records returned
+                - 0 when there are no more records in the time range or
+                  on error
+
+********************************************************************/
+
+int32_t read_llz_time_range (int32_t hnd, time_t start_sec, long start_nsec, time_t end_sec, long end_nsec, int64_t *cursor,
+                             int64_t *recnums, LLZ_REC *data, int32_t count)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  LLZ_QUERY query;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL || llz->layout.time_offset < 0) return (0);
+
+  memset (&query, 0, sizeof (LLZ_QUERY));
+
+  query.time = 1;
+  query.start = get_llz_query_time (start_sec, start_nsec);
+  query.end = get_llz_query_time (end_sec, end_nsec);
+
+  return (read_llz_query (hnd, &query, cursor, recnums, data, count));
+}
@@ -0,0 +1,287 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Internal definitions shared by the llz library source files.  Nothing in here is part of the public API.  */
+
+#ifndef __LLZ_INTERNAL_H__
+#define __LLZ_INTERNAL_H__
+
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include "llz.h"
+
+
+/*  The vectorized kernels in llz_kernels.c are only built for x86 with gcc compatible compilers (gcc, clang,
+    MinGW).  Everything else gets the scalar kernels.  */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LLZ_X86_KERNELS
+#endif
+
+
+/*  Byte layout of a single packed record on disk.  This is computed once per handle from the major version
+    and the time/uncertainty flags so that the bulk I/O routines don't have to keep re-deriving it.  */
+
+typedef struct
+{
+  uint16_t      record_size;          /*!<  Size, in bytes, of a packed record  */
+  int16_t       time_offset;          /*!<  Offset of tv_sec (tv_nsec follows it) or -1 if no time  */
+  int16_t       uncertainty_offset;   /*!<  Offset of uncertainty or -1 if no uncertainty  */
+  uint16_t      lat_offset;           /*!<  Offset of latitude (longitude and depth follow it)  */
+  uint16_t      stat_offset;          /*!<  Offset of status  */
+  uint8_t       stat_size;            /*!<  2 for version 4.00 and later, 4 for earlier versions  */
+} LLZ_LAYOUT;
+
+
+/*  Destination (or source) arrays for the decode (and encode) kernels.  Any of the pointers may be NULL to skip that field.  If stride is
+    0 each array is densely packed (i.e. structure of arrays), otherwise stride is the distance in bytes between
+    consecutive elements of every array (e.g. sizeof (LLZ_REC) when decoding into an array of LLZ_REC).  */
+
+typedef struct
+{
+  time_t        *tv_sec;
+  long          *tv_nsec;
+  float         *uncertainty;
+  double        *lat;
+  double        *lon;
+  float         *depth;
+  uint32_t      *status;
+  size_t        stride;
+} LLZ_COLUMNS;
+
+
+/*  Number of records summarized by each block of a bounding box index.  */
+
+#define LLZ_INDEX_BLOCK_RECORDS 4096
+
+
+/*  Bounding box (and time span) of one block of records in an index.  The values are the scaled integers that
+    are stored in the file so that they can be compared exactly.  The times are zero if the file has no time.  */
+
+typedef struct
+{
+  int32_t       min_lat;
+  int32_t       max_lat;
+  int32_t       min_lon;
+  int32_t       max_lon;
+  int32_t       min_depth;
+  int32_t       max_depth;
+  int32_t       min_sec;
+  int32_t       min_nsec;
+  int32_t       max_sec;
+  int32_t       max_nsec;
+} LLZ_INDEX_BLOCK;
+
+
+/*  A bounding box and time index loaded from the <llz file>.idx sidecar file.  */
+
+typedef struct
+{
+  int32_t       block_records;        /*!<  Records per block (the last block may have fewer)  */
+  int64_t       blocks;               /*!<  Number of blocks  */
+  uint8_t       time_monotonic;       /*!<  Set if the record times never decrease  */
+  LLZ_INDEX_BLOCK *block;
+} LLZ_INDEX;
+
+
+/*  Number of records in each block of a compressed llz file.  */
+
+#define LLZ_COMPRESS_BLOCK_RECORDS 4096
+
+
+/*  Block formats of a compressed llz file ([COMPRESSION] = DELTA or PACKED in the header).  */
+
+#define LLZ_COMPRESSION_DELTA 1
+#define LLZ_COMPRESSION_PACKED 2
+
+
+/*  Largest possible compressed size of count records.  Each of up to six 32 bit fields can take five bytes and each
+    status can start a new run (five bytes for the value and three for the run length).  A PACKED block never
+    uses more than that plus one encoding byte for each column.  */
+
+#define LLZ_COMPRESS_BOUND(count) ((size_t) (count) * 38 + 24)
+
+
+/*  Run time state for a block compressed llz file (see llz_compress.c).  */
+
+typedef struct
+{
+  int64_t       blocks;               /*!<  Number of compressed blocks in the file  */
+  int64_t       *offset;              /*!<  File offset of each block followed by the end of the last block  */
+  int64_t       table_size;           /*!<  Number of entries allocated in offset  */
+  uint8_t       *block;               /*!<  Records of the last block that was decompressed  */
+  int64_t       cached_block;         /*!<  Block number of the records in block or -1  */
+  uint8_t       *packed;              /*!<  Staging buffer for a compressed block  */
+  uint8_t       *pending;             /*!<  Records waiting for a full block (writing only)  */
+  int32_t       pending_count;
+  uint8_t       write;                /*!<  Set if the file was created with create_llz_compressed and isn't finished  */
+} LLZ_COMPRESSION;
+
+
+/*  A sequential read stream (see llz_stream.c).  The read ahead thread fills a buffer and marks it full, the
+    caller uses the records and marks it empty.  An empty buffer that is marked full ends the stream.  */
+
+typedef struct
+{
+  pthread_t     thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  uint8_t       *buffer[2];           /*!<  Packed records  */
+  int32_t       count[2];             /*!<  Number of records in each buffer  */
+  uint8_t       full[2];              /*!<  Set when a buffer is ready for the caller (protected by mutex)  */
+  int32_t       current;              /*!<  Buffer the caller is using  */
+  int32_t       used;                 /*!<  Records in the current buffer that the caller has used  */
+  uint8_t       held;                 /*!<  Set while the caller owns the current buffer  */
+  int64_t       next;                 /*!<  Next record to read  */
+  int64_t       end;                  /*!<  End of the stream  */
+  int32_t       chunk_records;        /*!<  Records per buffer  */
+  uint8_t       stop;                 /*!<  Tells the thread to quit (protected by mutex)  */
+  uint8_t       running;              /*!<  Set if the thread was started  */
+  uint8_t       sync;                 /*!<  Set if mutex and cond were initialized  */
+} LLZ_STREAM;
+
+
+/*  Statistics of the valid records (no LLZ_INVAL bits set) that are kept in the header (see llz_stats.c).  The
+    extents are the scaled integers that are stored in the records so that they can be maintained exactly.  */
+
+typedef struct
+{
+  int64_t       valid_count;
+  int32_t       min_lat;
+  int32_t       max_lat;
+  int32_t       min_lon;
+  int32_t       max_lon;
+  int32_t       min_depth;
+  int32_t       max_depth;
+} LLZ_HEADER_STATS;
+
+
+/*  State of the header statistics.  Once a change can't be accounted for without reading records (e.g. a valid
+    record that was on the edge of the extents was changed or invalidated) the statistics are unknown.  Unknown
+    statistics aren't written to the header and are only rescanned if get_llz_stats is called.  */
+
+#define LLZ_STATS_UNKNOWN 0
+#define LLZ_STATS_CURRENT 1
+
+
+/*  Internal state for each llz handle.  */
+
+typedef struct
+{
+  uint8_t       in_use;               /*!<  Handle is allocated (only changed while holding llz_handle_mutex)  */
+  int64_t       recnum;               /*!<  Next record for LLZ_NEXT_RECORD  */
+  FILE          *fp;
+  uint8_t       time_flag;            /*!<  This is duplicated in header due to the need to support 1.0 files.  */
+  uint8_t       uncertainty_flag;     /*!<  This is duplicated in header due to the need to support 1.0 files.  */
+  uint8_t       depth_units;          /*!<  This is duplicated in header due to the need to support 1.0 files.  */
+  uint8_t       swap;
+  uint8_t       at_end;
+  uint8_t       size_changed;
+  uint8_t       modified;
+  uint8_t       created;
+  uint8_t       write;
+  LLZ_HEADER    header;
+  int64_t       number_of_records64;  /*!<  64 bit record count (header.number_of_records is clamped to INT32_MAX)  */
+  uint16_t      major_version;
+  LLZ_LAYOUT    layout;
+  uint8_t       *buffer;              /*!<  Staging buffer for bulk I/O  */
+  size_t        buffer_size;
+  uint8_t       *raw_buffer;          /*!<  read_llz_raw buffer (the view must outlive other calls)  */
+  size_t        raw_buffer_size;
+  uint8_t       read_only;            /*!<  Set if opened with open_llz_mmap  */
+  uint8_t       *map;                 /*!<  Memory mapped file or NULL  */
+  size_t        map_size;
+  int64_t       map_records;          /*!<  Number of complete records in the mapping  */
+  char          *path;                /*!<  The llz file path  */
+  LLZ_INDEX     *index;               /*!<  Bounding box index or NULL  */
+  uint8_t       index_checked;        /*!<  Set once we've tried to load the index  */
+  uint8_t       compressed;           /*!<  LLZ_COMPRESSION_DELTA or LLZ_COMPRESSION_PACKED if [COMPRESSION] is in the header  */
+  int32_t       block_records;        /*!<  [BLOCK RECORDS] of a compressed file  */
+  int64_t       block_table;          /*!<  [BLOCK TABLE] offset of a compressed file  */
+  LLZ_COMPRESSION *compression;       /*!<  Compression state or NULL  */
+  LLZ_STREAM    *stream;              /*!<  Sequential read stream or NULL  */
+  uint8_t       *ahead;               /*!<  read_llz read ahead buffer  */
+  int64_t       ahead_start;          /*!<  First record in ahead  */
+  int32_t       ahead_count;          /*!<  Number of records in ahead  */
+  LLZ_HEADER_STATS stats;              /*!<  Header statistics  */
+  uint8_t       stats_state;          /*!<  LLZ_STATS_UNKNOWN or LLZ_STATS_CURRENT  */
+} INTERNAL_LLZ_HEADER;
+
+
+  INTERNAL_LLZ_HEADER *get_llz_handle (int32_t hnd);
+  void decode_llz_records (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t count, LLZ_REC *data);
+  void encode_llz_records (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_REC *data, int32_t count, uint8_t *buf);
+  LLZ_INDEX *load_llz_index (const INTERNAL_LLZ_HEADER *llz);
+  void free_llz_index (LLZ_INDEX *index);
+  void remove_llz_index (const char *path);
+  void decode_llz_block (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t count, const LLZ_COLUMNS *dest);
+  void encode_llz_block (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t count, uint8_t *buf);
+  void encode_llz_status (const LLZ_LAYOUT *layout, uint8_t swap, uint32_t status, uint8_t *field);
+  void encode_llz_scalar (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t start, int32_t count, uint8_t *buf);
+#ifdef LLZ_X86_KERNELS
+  void encode_llz_sse2 (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t start, int32_t count, uint8_t *buf);
+  void encode_llz_avx2 (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t start, int32_t count, uint8_t *buf);
+#endif
+  size_t pread_llz_bytes (const INTERNAL_LLZ_HEADER *llz, int64_t pos, size_t size, uint8_t *buf);
+  size_t pwrite_llz_bytes (const INTERNAL_LLZ_HEADER *llz, int64_t pos, size_t size, const uint8_t *buf);
+  void sync_llz_record_count (INTERNAL_LLZ_HEADER *llz);
+  uint8_t open_llz_compression (INTERNAL_LLZ_HEADER *llz);
+  uint8_t start_llz_compression (INTERNAL_LLZ_HEADER *llz);
+  uint8_t finish_llz_compression (INTERNAL_LLZ_HEADER *llz);
+  void free_llz_compression (LLZ_COMPRESSION *compression);
+  int32_t append_llz_compressed (INTERNAL_LLZ_HEADER *llz, const LLZ_REC *data, int32_t count);
+  int32_t read_llz_compressed (INTERNAL_LLZ_HEADER *llz, int64_t start, int32_t count, uint8_t *buf);
+  int32_t pread_llz_compressed (const INTERNAL_LLZ_HEADER *llz, int64_t start, int32_t count, uint8_t *buf);
+  int32_t decompress_llz_block (const INTERNAL_LLZ_HEADER *llz, int64_t block, const uint8_t *packed, uint8_t *rec);
+  void add_llz_stats (INTERNAL_LLZ_HEADER *llz, const uint8_t *rec, int32_t count);
+  void change_llz_stats (INTERNAL_LLZ_HEADER *llz, const uint8_t *old_rec, const uint8_t *new_rec, int32_t count);
+  void merge_llz_stats (LLZ_HEADER_STATS *stats, const LLZ_HEADER_STATS *other);
+  uint8_t scan_llz_stats (INTERNAL_LLZ_HEADER *llz);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
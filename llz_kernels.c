@@ -0,0 +1,1098 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "llz_internal.h"
+#include "swap_bytes.h"
+
+
+/*  The instruction set is selected at run time so the library doesn't have to be built with -mavx2 (see
+    LLZ_X86_KERNELS in llz_internal.h).  */
+
+#ifdef LLZ_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+typedef void (*DECODE_KERNEL) (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t start, int32_t count,
+                               const LLZ_COLUMNS *dest);
+
+typedef void (*ENCODE_KERNEL) (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t start, int32_t count,
+                               uint8_t *buf);
+
+static DECODE_KERNEL decode_kernel = NULL;
+static ENCODE_KERNEL encode_kernel = NULL;
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+
+/*  Address of element i of a destination array.  */
+
+#define COLUMN(ptr, type, i, stride) ((type *) ((uint8_t *) (ptr) + (size_t) (i) * ((stride) ? (stride) : sizeof (type))))
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    decode_llz_scalar
+
+ - Purpose:     Decode packed, on-disk llz records one at a time.  This
+                is the fallback for CPUs without SSE2/AVX2 and is also
+                used for the leftover records at the end of a block.
+                Position is scaled in double precision so that the
+                results are identical to the vector kernels.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - buf            =    The packed records
+                - start          =    First record to decode
+                - count          =    Number of records in buf
+                - dest           =    Destination arrays
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void decode_llz_scalar (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t start, int32_t count,
+                               const LLZ_COLUMNS *dest)
+{
+  int32_t i, tv_sec, tv_nsec, uncertainty, lat, lon, dep, tmpi;
+  int16_t stat16;
+  uint16_t stat;
+  const uint8_t *rec;
+
+
+  tv_sec = tv_nsec = uncertainty = 0;
+
+  for (i = start ; i < count ; i++)
+    {
+      rec = buf + (size_t) i * layout->record_size;
+
+      if (layout->time_offset >= 0)
+        {
+          memcpy (&tv_sec, rec + layout->time_offset, sizeof (int32_t));
+          memcpy (&tv_nsec, rec + layout->time_offset + sizeof (int32_t), sizeof (int32_t));
+        }
+
+      if (layout->uncertainty_offset >= 0) memcpy (&uncertainty, rec + layout->uncertainty_offset, sizeof (int32_t));
+
+      memcpy (&lat, rec + layout->lat_offset, sizeof (int32_t));
+      memcpy (&lon, rec + layout->lat_offset + sizeof (int32_t), sizeof (int32_t));
+      memcpy (&dep, rec + layout->lat_offset + 2 * sizeof (int32_t), sizeof (int32_t));
+
+
+      /*  Pre-4.00 files store the 16 bit status in a 32 bit field.  */
+
+      if (layout->stat_size == sizeof (uint32_t))
+        {
+          memcpy (&tmpi, rec + layout->stat_offset, sizeof (int32_t));
+          if (swap) swap_int (&tmpi);
+          stat = (uint16_t) tmpi;
+        }
+      else
+        {
+          memcpy (&stat16, rec + layout->stat_offset, sizeof (int16_t));
+          if (swap) swap_short (&stat16);
+          stat = (uint16_t) stat16;
+        }
+
+      if (swap)
+        {
+          swap_int (&tv_sec);
+          swap_int (&tv_nsec);
+          swap_int (&uncertainty);
+          swap_int (&lat);
+          swap_int (&lon);
+          swap_int (&dep);
+        }
+
+      if (dest->tv_sec) *COLUMN (dest->tv_sec, time_t, i, dest->stride) = tv_sec;
+      if (dest->tv_nsec) *COLUMN (dest->tv_nsec, long, i, dest->stride) = tv_nsec;
+      if (dest->uncertainty) *COLUMN (dest->uncertainty, float, i, dest->stride) = (float) uncertainty / 10000.0f;
+      if (dest->lat) *COLUMN (dest->lat, double, i, dest->stride) = (double) lat / 10000000.0;
+      if (dest->lon) *COLUMN (dest->lon, double, i, dest->stride) = (double) lon / 10000000.0;
+      if (dest->depth) *COLUMN (dest->depth, float, i, dest->stride) = (float) dep / 10000.0f;
+      if (dest->status) *COLUMN (dest->status, uint32_t, i, dest->stride) = (uint32_t) stat;
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pack_llz_status
+
+ - Purpose:     Byte swap (if needed) and store a status value in the
+                on-disk status field.  Pre-4.00 files get the 16 bit
+                status stored in the low order bytes of a 32 bit field.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the record needs to be byte swapped
+                - stat           =    Status
+                - field          =    The status field of the packed record
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static inline void pack_llz_status (const LLZ_LAYOUT *layout, uint8_t swap, uint16_t stat, uint8_t *field)
+{
+  int32_t tmpi;
+  int16_t stat16;
+
+
+  if (layout->stat_size == sizeof (uint32_t))
+    {
+      tmpi = (int32_t) stat;
+      if (swap) swap_int (&tmpi);
+      memcpy (field, &tmpi, sizeof (int32_t));
+    }
+  else
+    {
+      stat16 = (int16_t) stat;
+      if (swap) swap_short (&stat16);
+      memcpy (field, &stat16, sizeof (int16_t));
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    pack_llz_record
+
+ - Purpose:     Byte swap (if needed) and store one record's fixed point
+                values in the on-disk layout.  Pre-4.00 files get the
+                16 bit status stored in the low order bytes of a 32 bit
+                field.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the record needs to be byte swapped
+                - value          =    tv_sec, tv_nsec, uncertainty, lat, lon, depth
+                - stat           =    Status
+                - rec            =    The packed record
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static inline void pack_llz_record (const LLZ_LAYOUT *layout, uint8_t swap, int32_t *value, uint16_t stat, uint8_t *rec)
+{
+  int32_t i;
+
+
+  if (swap) for (i = 0 ; i < 6 ; i++) swap_int (&value[i]);
+
+  if (layout->time_offset >= 0) memcpy (rec + layout->time_offset, &value[0], 2 * sizeof (int32_t));
+
+  if (layout->uncertainty_offset >= 0) memcpy (rec + layout->uncertainty_offset, &value[2], sizeof (int32_t));
+
+  memcpy (rec + layout->lat_offset, &value[3], 3 * sizeof (int32_t));
+
+  pack_llz_status (layout, swap, stat, rec + layout->stat_offset);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    encode_llz_status
+
+ - Purpose:     Store a status value in the on-disk status field of a
+                packed record.  This is exactly what the record encoders
+                do with the status and is used to update the status of a
+                record without touching the rest of it.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the record needs to be byte swapped
+                - status         =    Status
+                - field          =    The status field of the packed record
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void encode_llz_status (const LLZ_LAYOUT *layout, uint8_t swap, uint32_t status, uint8_t *field)
+{
+  pack_llz_status (layout, swap, (uint16_t) status, field);
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    encode_llz_scalar
+
+ - Purpose:     Encode records to the packed, on-disk layout one at a
+                time using NINT.  This is the reference that the vector
+                kernels have to match and it is also used for leftover
+                records and for any group of records that the vector
+                kernels can't round with certainty.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - src            =    Source arrays
+                - start          =    First record to encode
+                - count          =    Number of records in src
+                - buf            =    The packed records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void encode_llz_scalar (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t start, int32_t count,
+                               uint8_t *buf)
+{
+  int32_t i, value[6];
+  uint16_t stat;
+
+
+  for (i = start ; i < count ; i++)
+    {
+      value[0] = src->tv_sec ? (int32_t) *COLUMN (src->tv_sec, time_t, i, src->stride) : 0;
+      value[1] = src->tv_nsec ? (int32_t) *COLUMN (src->tv_nsec, long, i, src->stride) : 0;
+      value[2] = src->uncertainty ? NINT (*COLUMN (src->uncertainty, float, i, src->stride) * 10000.0L) : 0;
+      value[3] = NINT (*COLUMN (src->lat, double, i, src->stride) * 10000000.0L);
+      value[4] = NINT (*COLUMN (src->lon, double, i, src->stride) * 10000000.0L);
+      value[5] = NINT (*COLUMN (src->depth, float, i, src->stride) * 10000.0L);
+      stat = src->status ? (uint16_t) *COLUMN (src->status, uint32_t, i, src->stride) : 0;
+
+      pack_llz_record (layout, swap, value, stat, buf + (size_t) i * layout->record_size);
+    }
+}
+
+
+
+#ifdef LLZ_X86_KERNELS
+
+/*  Unaligned 32 bit load from a packed record.  */
+
+static inline int32_t load_int32 (const uint8_t *ptr)
+{
+  int32_t value;
+
+  memcpy (&value, ptr, sizeof (int32_t));
+
+  return (value);
+}
+
+
+/*  Time is just copied so there's nothing to gain from doing it in vector registers (and time_t/long are not the
+    same size on all platforms).  */
+
+static inline void decode_llz_time (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t i, int32_t n,
+                                    const LLZ_COLUMNS *dest)
+{
+  int32_t k, tv_sec, tv_nsec;
+  const uint8_t *rec;
+
+
+  for (k = i ; k < i + n ; k++)
+    {
+      tv_sec = tv_nsec = 0;
+
+      if (layout->time_offset >= 0)
+        {
+          rec = buf + (size_t) k * layout->record_size + layout->time_offset;
+
+          tv_sec = load_int32 (rec);
+          tv_nsec = load_int32 (rec + sizeof (int32_t));
+
+          if (swap)
+            {
+              swap_int (&tv_sec);
+              swap_int (&tv_nsec);
+            }
+        }
+
+      if (dest->tv_sec) *COLUMN (dest->tv_sec, time_t, k, dest->stride) = tv_sec;
+      if (dest->tv_nsec) *COLUMN (dest->tv_nsec, long, k, dest->stride) = tv_nsec;
+    }
+}
+
+
+/*  Scatter n decoded values to a (possibly strided) destination array.  */
+
+#define SCATTER(ptr, type, values, i, n, stride) \
+  { \
+    int32_t k_; \
+    for (k_ = 0 ; k_ < (n) ; k_++) *COLUMN ((ptr), type, (i) + k_, (stride)) = (values)[k_]; \
+  }
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    decode_llz_sse2
+
+ - Purpose:     Decode packed, on-disk llz records four at a time using
+                SSE2.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - buf            =    The packed records
+                - start          =    First record to decode
+                - count          =    Number of records in buf
+                - dest           =    Destination arrays
+
+ - Returns:     N/A
+
+********************************************************************/
+
+__attribute__ ((target ("sse2")))
+static void decode_llz_sse2 (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t start, int32_t count,
+                             const LLZ_COLUMNS *dest)
+{
+  int32_t i;
+  size_t rs = layout->record_size;
+  const uint8_t *r0;
+  __m128i v, mask16 = _mm_set1_epi32 (0xffff);
+  __m128d pos_scale = _mm_set1_pd (10000000.0);
+  __m128 z_scale = _mm_set1_ps (10000.0f);
+  double dval[4];
+  float fval[4];
+  uint32_t uval[4];
+
+
+#define LOAD4(off) _mm_set_epi32 (load_int32 (r0 + 3 * rs + (off)), load_int32 (r0 + 2 * rs + (off)), \
+                                  load_int32 (r0 + rs + (off)), load_int32 (r0 + (off)))
+
+  /*  Byte swap each 32 bit lane (swap the 16 bit halves then the bytes within each half).  */
+
+#define BSWAP4(x) (x = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (x, 0xb1), 0xb1), \
+                   x = _mm_or_si128 (_mm_slli_epi16 (x, 8), _mm_srli_epi16 (x, 8)))
+
+
+  for (i = start ; i + 4 <= count ; i += 4)
+    {
+      r0 = buf + (size_t) i * rs;
+
+      decode_llz_time (layout, swap, buf, i, 4, dest);
+
+      if (dest->uncertainty)
+        {
+          if (layout->uncertainty_offset >= 0)
+            {
+              v = LOAD4 (layout->uncertainty_offset);
+              if (swap) BSWAP4 (v);
+              _mm_storeu_ps (fval, _mm_div_ps (_mm_cvtepi32_ps (v), z_scale));
+            }
+          else
+            {
+              _mm_storeu_ps (fval, _mm_setzero_ps ());
+            }
+
+          SCATTER (dest->uncertainty, float, fval, i, 4, dest->stride);
+        }
+
+      if (dest->lat)
+        {
+          v = LOAD4 (layout->lat_offset);
+          if (swap) BSWAP4 (v);
+          _mm_storeu_pd (dval, _mm_div_pd (_mm_cvtepi32_pd (v), pos_scale));
+          _mm_storeu_pd (dval + 2, _mm_div_pd (_mm_cvtepi32_pd (_mm_shuffle_epi32 (v, 0xee)), pos_scale));
+          SCATTER (dest->lat, double, dval, i, 4, dest->stride);
+        }
+
+      if (dest->lon)
+        {
+          v = LOAD4 (layout->lat_offset + 4);
+          if (swap) BSWAP4 (v);
+          _mm_storeu_pd (dval, _mm_div_pd (_mm_cvtepi32_pd (v), pos_scale));
+          _mm_storeu_pd (dval + 2, _mm_div_pd (_mm_cvtepi32_pd (_mm_shuffle_epi32 (v, 0xee)), pos_scale));
+          SCATTER (dest->lon, double, dval, i, 4, dest->stride);
+        }
+
+      if (dest->depth)
+        {
+          v = LOAD4 (layout->lat_offset + 8);
+          if (swap) BSWAP4 (v);
+          _mm_storeu_ps (fval, _mm_div_ps (_mm_cvtepi32_ps (v), z_scale));
+          SCATTER (dest->depth, float, fval, i, 4, dest->stride);
+        }
+
+      if (dest->status)
+        {
+          /*  For 16 bit status we load the 32 bits ending at the end of the status (so we never read past the end
+              of the buffer) and shift the status down.  */
+
+          if (layout->stat_size == sizeof (uint32_t))
+            {
+              v = LOAD4 (layout->stat_offset);
+              if (swap) BSWAP4 (v);
+              v = _mm_and_si128 (v, mask16);
+            }
+          else
+            {
+              v = _mm_srli_epi32 (LOAD4 (layout->stat_offset - 2), 16);
+              if (swap) v = _mm_and_si128 (_mm_or_si128 (_mm_slli_epi32 (v, 8), _mm_srli_epi32 (v, 8)), mask16);
+            }
+
+          _mm_storeu_si128 ((__m128i *) uval, v);
+          SCATTER (dest->status, uint32_t, uval, i, 4, dest->stride);
+        }
+    }
+
+#undef LOAD4
+#undef BSWAP4
+
+  decode_llz_scalar (layout, swap, buf, i, count, dest);
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    decode_llz_avx2
+
+ - Purpose:     Decode packed, on-disk llz records eight at a time
+                using AVX2 gathers and byte shuffles.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - buf            =    The packed records
+                - start          =    First record to decode
+                - count          =    Number of records in buf
+                - dest           =    Destination arrays
+
+ - Returns:     N/A
+
+********************************************************************/
+
+__attribute__ ((target ("avx2")))
+static void decode_llz_avx2 (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t start, int32_t count,
+                             const LLZ_COLUMNS *dest)
+{
+  int32_t i, rs = layout->record_size;
+  const int *r0;
+  __m256i v, index, mask16 = _mm256_set1_epi32 (0xffff);
+  __m256i bswap32 = _mm256_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  __m256i bswap16 = _mm256_setr_epi8 (1, 0, -1, -1, 5, 4, -1, -1, 9, 8, -1, -1, 13, 12, -1, -1,
+                                      1, 0, -1, -1, 5, 4, -1, -1, 9, 8, -1, -1, 13, 12, -1, -1);
+  __m256d pos_scale = _mm256_set1_pd (10000000.0);
+  __m256 z_scale = _mm256_set1_ps (10000.0f);
+  double dval[8];
+  float fval[8];
+  uint32_t uval[8];
+
+
+  index = _mm256_setr_epi32 (0, rs, 2 * rs, 3 * rs, 4 * rs, 5 * rs, 6 * rs, 7 * rs);
+
+#define GATHER8(off) _mm256_i32gather_epi32 ((const int *) ((const uint8_t *) r0 + (off)), index, 1)
+
+
+  for (i = start ; i + 8 <= count ; i += 8)
+    {
+      r0 = (const int *) (buf + (size_t) i * rs);
+
+      decode_llz_time (layout, swap, buf, i, 8, dest);
+
+      if (dest->uncertainty)
+        {
+          if (layout->uncertainty_offset >= 0)
+            {
+              v = GATHER8 (layout->uncertainty_offset);
+              if (swap) v = _mm256_shuffle_epi8 (v, bswap32);
+              _mm256_storeu_ps (fval, _mm256_div_ps (_mm256_cvtepi32_ps (v), z_scale));
+            }
+          else
+            {
+              _mm256_storeu_ps (fval, _mm256_setzero_ps ());
+            }
+
+          SCATTER (dest->uncertainty, float, fval, i, 8, dest->stride);
+        }
+
+      if (dest->lat)
+        {
+          v = GATHER8 (layout->lat_offset);
+          if (swap) v = _mm256_shuffle_epi8 (v, bswap32);
+          _mm256_storeu_pd (dval, _mm256_div_pd (_mm256_cvtepi32_pd (_mm256_castsi256_si128 (v)), pos_scale));
+          _mm256_storeu_pd (dval + 4, _mm256_div_pd (_mm256_cvtepi32_pd (_mm256_extracti128_si256 (v, 1)), pos_scale));
+          SCATTER (dest->lat, double, dval, i, 8, dest->stride);
+        }
+
+      if (dest->lon)
+        {
+          v = GATHER8 (layout->lat_offset + 4);
+          if (swap) v = _mm256_shuffle_epi8 (v, bswap32);
+          _mm256_storeu_pd (dval, _mm256_div_pd (_mm256_cvtepi32_pd (_mm256_castsi256_si128 (v)), pos_scale));
+          _mm256_storeu_pd (dval + 4, _mm256_div_pd (_mm256_cvtepi32_pd (_mm256_extracti128_si256 (v, 1)), pos_scale));
+          SCATTER (dest->lon, double, dval, i, 8, dest->stride);
+        }
+
+      if (dest->depth)
+        {
+          v = GATHER8 (layout->lat_offset + 8);
+          if (swap) v = _mm256_shuffle_epi8 (v, bswap32);
+          _mm256_storeu_ps (fval, _mm256_div_ps (_mm256_cvtepi32_ps (v), z_scale));
+          SCATTER (dest->depth, float, fval, i, 8, dest->stride);
+        }
+
+      if (dest->status)
+        {
+          /*  See decode_llz_sse2 for why the 16 bit status is loaded from 2 bytes before it.  */
+
+          if (layout->stat_size == sizeof (uint32_t))
+            {
+              v = GATHER8 (layout->stat_offset);
+              if (swap) v = _mm256_shuffle_epi8 (v, bswap32);
+              v = _mm256_and_si256 (v, mask16);
+            }
+          else
+            {
+              v = _mm256_srli_epi32 (GATHER8 (layout->stat_offset - 2), 16);
+              if (swap) v = _mm256_shuffle_epi8 (v, bswap16);
+            }
+
+          _mm256_storeu_si256 ((__m256i *) uval, v);
+          SCATTER (dest->status, uint32_t, uval, i, 8, dest->stride);
+        }
+    }
+
+#undef GATHER8
+
+  decode_llz_scalar (layout, swap, (const uint8_t *) buf, i, count, dest);
+}
+
+
+
+/*  Rounding in the vector encoders:  NINT rounds half away from zero on a long double product.  The vector kernels
+    multiply in double, which can differ from the long double product by a tiny fraction of a unit, so the two can
+    only disagree when the product is within that tiny fraction of a half (or is out of int32_t range, or NaN).
+    Any group of records with a value within ROUND_GUARD of a half is handed to encode_llz_scalar so the results
+    always match NINT bit for bit.  Depth and uncertainty are floats so their products are exact in double.  */
+
+#define ROUND_GUARD   (1.0 / 65536.0)
+#define ROUND_LIMIT   2147483647.0
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    round_llz_sse2
+
+ - Purpose:     Round two scaled values to the nearest integer, half
+                away from zero.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - value          =    The scaled values
+                - result         =    The rounded values
+
+ - Returns:
+                - 0 if either value is too close to a half (or out of
+                  range) to be certain that we match NINT
+                - 1
+
+********************************************************************/
+
+__attribute__ ((target ("sse2")))
+static inline int32_t round_llz_sse2 (__m128d value, int32_t *result)
+{
+  __m128d sign = _mm_set1_pd (-0.0), half = _mm_set1_pd (0.5), mag, frac, ok;
+
+
+  mag = _mm_andnot_pd (sign, value);
+  frac = _mm_sub_pd (mag, _mm_cvtepi32_pd (_mm_cvttpd_epi32 (mag)));
+
+  ok = _mm_and_pd (_mm_cmplt_pd (mag, _mm_set1_pd (ROUND_LIMIT)),
+                   _mm_cmpgt_pd (_mm_andnot_pd (sign, _mm_sub_pd (frac, half)), _mm_set1_pd (ROUND_GUARD)));
+
+  if (_mm_movemask_pd (ok) != 3) return (0);
+
+  _mm_storel_epi64 ((__m128i *) result, _mm_cvttpd_epi32 (_mm_add_pd (value, _mm_or_pd (half, _mm_and_pd (sign, value)))));
+
+  return (1);
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    encode_llz_sse2
+
+ - Purpose:     Encode records to the packed, on-disk layout two at a
+                time using SSE2.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - src            =    Source arrays
+                - start          =    First record to encode
+                - count          =    Number of records in src
+                - buf            =    The packed records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+__attribute__ ((target ("sse2")))
+void encode_llz_sse2 (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t start, int32_t count,
+                             uint8_t *buf)
+{
+  int32_t i, k, value[2][6], field[2];
+  uint16_t stat[2];
+  __m128d pos_scale = _mm_set1_pd (10000000.0), z_scale = _mm_set1_pd (10000.0);
+
+
+#define LOAD2D(ptr) _mm_set_pd (*COLUMN ((ptr), double, i + 1, src->stride), *COLUMN ((ptr), double, i, src->stride))
+#define LOAD2F(ptr) _mm_set_pd ((double) *COLUMN ((ptr), float, i + 1, src->stride), (double) *COLUMN ((ptr), float, i, src->stride))
+#define ROUND2(v, idx) \
+  { \
+    if (!round_llz_sse2 ((v), field)) \
+      { \
+        encode_llz_scalar (layout, swap, src, i, i + 2, buf); \
+        continue; \
+      } \
+    value[0][idx] = field[0]; \
+    value[1][idx] = field[1]; \
+  }
+
+
+  for (i = start ; i + 2 <= count ; i += 2)
+    {
+      for (k = 0 ; k < 2 ; k++)
+        {
+          value[k][0] = src->tv_sec ? (int32_t) *COLUMN (src->tv_sec, time_t, i + k, src->stride) : 0;
+          value[k][1] = src->tv_nsec ? (int32_t) *COLUMN (src->tv_nsec, long, i + k, src->stride) : 0;
+          value[k][2] = 0;
+          stat[k] = src->status ? (uint16_t) *COLUMN (src->status, uint32_t, i + k, src->stride) : 0;
+        }
+
+      if (src->uncertainty) ROUND2 (_mm_mul_pd (LOAD2F (src->uncertainty), z_scale), 2);
+      ROUND2 (_mm_mul_pd (LOAD2D (src->lat), pos_scale), 3);
+      ROUND2 (_mm_mul_pd (LOAD2D (src->lon), pos_scale), 4);
+      ROUND2 (_mm_mul_pd (LOAD2F (src->depth), z_scale), 5);
+
+      for (k = 0 ; k < 2 ; k++) pack_llz_record (layout, swap, value[k], stat[k], buf + (size_t) (i + k) * layout->record_size);
+    }
+
+#undef LOAD2D
+#undef LOAD2F
+#undef ROUND2
+
+  encode_llz_scalar (layout, swap, src, i, count, buf);
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    round_llz_avx2
+
+ - Purpose:     Round four scaled values to the nearest integer, half
+                away from zero.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - value          =    The scaled values
+                - result         =    The rounded values
+
+ - Returns:
+                - 0 if any value is too close to a half (or out of
+                  range) to be certain that we match NINT
+                - 1
+
+********************************************************************/
+
+__attribute__ ((target ("avx2")))
+static inline int32_t round_llz_avx2 (__m256d value, __m128i *result)
+{
+  __m256d sign = _mm256_set1_pd (-0.0), half = _mm256_set1_pd (0.5), mag, frac, ok;
+
+
+  mag = _mm256_andnot_pd (sign, value);
+  frac = _mm256_sub_pd (mag, _mm256_round_pd (mag, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+
+  ok = _mm256_and_pd (_mm256_cmp_pd (mag, _mm256_set1_pd (ROUND_LIMIT), _CMP_LT_OQ),
+                      _mm256_cmp_pd (_mm256_andnot_pd (sign, _mm256_sub_pd (frac, half)), _mm256_set1_pd (ROUND_GUARD), _CMP_GT_OQ));
+
+  if (_mm256_movemask_pd (ok) != 15) return (0);
+
+  *result = _mm256_cvttpd_epi32 (_mm256_add_pd (value, _mm256_or_pd (half, _mm256_and_pd (sign, value))));
+
+  return (1);
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    encode_llz_avx2
+
+ - Purpose:     Encode records to the packed, on-disk layout four at a
+                time using AVX2.  The fixed point values are converted,
+                rounded, and byte swapped in vector registers and then
+                stored to each record.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - src            =    Source arrays
+                - start          =    First record to encode
+                - count          =    Number of records in src
+                - buf            =    The packed records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+__attribute__ ((target ("avx2")))
+void encode_llz_avx2 (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t start, int32_t count,
+                             uint8_t *buf)
+{
+  int32_t i, k, tv_sec, tv_nsec, tmpi, unc[4], lat[4], lon[4], dep[4];
+  size_t stride;
+  int16_t stat16;
+  uint16_t stat;
+  uint8_t *rec;
+  __m128i field, index, bswap32 = _mm_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  __m256d pos_scale = _mm256_set1_pd (10000000.0), z_scale = _mm256_set1_pd (10000.0);
+
+
+  stride = src->stride;
+
+#define LOAD4D(ptr) (stride ? _mm256_i32gather_pd (COLUMN ((ptr), double, i, stride), index, 1) : \
+                     _mm256_loadu_pd (COLUMN ((ptr), double, i, stride)))
+#define LOAD4F(ptr) _mm256_cvtps_pd (stride ? _mm_i32gather_ps (COLUMN ((ptr), float, i, stride), index, 1) : \
+                                     _mm_loadu_ps (COLUMN ((ptr), float, i, stride)))
+#define ROUND4(v, out) \
+  { \
+    if (!round_llz_avx2 ((v), &field)) \
+      { \
+        encode_llz_scalar (layout, swap, src, i, i + 4, buf); \
+        continue; \
+      } \
+    if (swap) field = _mm_shuffle_epi8 (field, bswap32); \
+    _mm_storeu_si128 ((__m128i *) (out), field); \
+  }
+
+  index = _mm_setr_epi32 (0, (int32_t) stride, 2 * (int32_t) stride, 3 * (int32_t) stride);
+
+  unc[0] = unc[1] = unc[2] = unc[3] = 0;
+
+  for (i = start ; i + 4 <= count ; i += 4)
+    {
+      if (src->uncertainty) ROUND4 (_mm256_mul_pd (LOAD4F (src->uncertainty), z_scale), unc);
+      ROUND4 (_mm256_mul_pd (LOAD4D (src->lat), pos_scale), lat);
+      ROUND4 (_mm256_mul_pd (LOAD4D (src->lon), pos_scale), lon);
+      ROUND4 (_mm256_mul_pd (LOAD4F (src->depth), z_scale), dep);
+
+      for (k = 0 ; k < 4 ; k++)
+        {
+          rec = buf + (size_t) (i + k) * layout->record_size;
+
+          if (layout->time_offset >= 0)
+            {
+              tv_sec = src->tv_sec ? (int32_t) *COLUMN (src->tv_sec, time_t, i + k, stride) : 0;
+              tv_nsec = src->tv_nsec ? (int32_t) *COLUMN (src->tv_nsec, long, i + k, stride) : 0;
+
+              if (swap)
+                {
+                  swap_int (&tv_sec);
+                  swap_int (&tv_nsec);
+                }
+
+              memcpy (rec + layout->time_offset, &tv_sec, sizeof (int32_t));
+              memcpy (rec + layout->time_offset + sizeof (int32_t), &tv_nsec, sizeof (int32_t));
+            }
+
+          if (layout->uncertainty_offset >= 0) memcpy (rec + layout->uncertainty_offset, &unc[k], sizeof (int32_t));
+
+          memcpy (rec + layout->lat_offset, &lat[k], sizeof (int32_t));
+          memcpy (rec + layout->lat_offset + sizeof (int32_t), &lon[k], sizeof (int32_t));
+          memcpy (rec + layout->lat_offset + 2 * sizeof (int32_t), &dep[k], sizeof (int32_t));
+
+          stat = src->status ? (uint16_t) *COLUMN (src->status, uint32_t, i + k, stride) : 0;
+
+          if (layout->stat_size == sizeof (uint32_t))
+            {
+              tmpi = (int32_t) stat;
+              if (swap) swap_int (&tmpi);
+              memcpy (rec + layout->stat_offset, &tmpi, sizeof (int32_t));
+            }
+          else
+            {
+              stat16 = (int16_t) stat;
+              if (swap) swap_short (&stat16);
+              memcpy (rec + layout->stat_offset, &stat16, sizeof (int16_t));
+            }
+        }
+    }
+
+#undef LOAD4D
+#undef LOAD4F
+#undef ROUND4
+
+  encode_llz_scalar (layout, swap, src, i, count, buf);
+}
+
+#endif
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    select_llz_kernels
+
+ - Purpose:     Pick the fastest kernels that the CPU supports.  This
+                is only called once (via pthread_once).
+
+ - Date:        10/16/26
+
+ - Arguments:   N/A
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void select_llz_kernels ()
+{
+  DECODE_KERNEL decode = decode_llz_scalar;
+  ENCODE_KERNEL encode = encode_llz_scalar;
+
+
+#ifdef LLZ_X86_KERNELS
+
+  __builtin_cpu_init ();
+
+  if (__builtin_cpu_supports ("avx2"))
+    {
+      decode = decode_llz_avx2;
+      encode = encode_llz_avx2;
+    }
+  else if (__builtin_cpu_supports ("sse2"))
+    {
+      decode = decode_llz_sse2;
+      encode = encode_llz_sse2;
+    }
+
+#endif
+
+
+  encode_kernel = encode;
+  decode_kernel = decode;
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    decode_llz_block
+
+ - Purpose:     Convert a block of packed, on-disk llz records to
+                decimal values in the dest arrays using the fastest
+                kernel available on this CPU.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - buf            =    The packed records
+                - count          =    Number of records in buf
+                - dest           =    Destination arrays
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void decode_llz_block (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t count, const LLZ_COLUMNS *dest)
+{
+  pthread_once (&kernel_once, select_llz_kernels);
+
+  (*decode_kernel) (layout, swap, buf, 0, count, dest);
+}
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    encode_llz_block
+
+ - Purpose:     Convert records in the src arrays to packed, on-disk llz
+                records using the fastest kernel available on this CPU.
+                The fixed point values are always identical to NINT.
+                The lat, lon, and depth arrays are required, the others
+                may be NULL (in which case zero is stored).
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - src            =    Source arrays
+                - count          =    Number of records in src
+                - buf            =    The packed records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void encode_llz_block (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t count, uint8_t *buf)
+{
+  pthread_once (&kernel_once, select_llz_kernels);
+
+  (*encode_kernel) (layout, swap, src, 0, count, buf);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    decode_llz_records
+
+ - Purpose:     Convert a block of packed, on-disk llz records to LLZ_REC
+                structures.  The packed records must be laid out as
+                described by layout.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - buf            =    The packed records
+                - count          =    Number of records in buf
+                - data           =    The returned llz records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void decode_llz_records (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *buf, int32_t count, LLZ_REC *data)
+{
+  LLZ_COLUMNS dest;
+
+
+  /*  Decode straight into the LLZ_REC array by using the record size as the stride for every field.  */
+
+  dest.tv_sec = &data[0].tv_sec;
+  dest.tv_nsec = &data[0].tv_nsec;
+  dest.uncertainty = &data[0].uncertainty;
+  dest.lat = &data[0].xy.lat;
+  dest.lon = &data[0].xy.lon;
+  dest.depth = &data[0].depth;
+  dest.status = &data[0].status;
+  dest.stride = sizeof (LLZ_REC);
+
+  decode_llz_block (layout, swap, buf, count, &dest);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    encode_llz_records
+
+ - Purpose:     Convert LLZ_REC structures to packed, on-disk llz
+                records laid out as described by layout.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The on-disk record layout
+                - swap           =    Set if the records need to be byte swapped
+                - data           =    The llz records
+                - count          =    Number of records in data
+                - buf            =    The returned packed records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void encode_llz_records (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_REC *data, int32_t count, uint8_t *buf)
+{
+  LLZ_COLUMNS src;
+
+
+  /*  Encode straight from the LLZ_REC array by using the record size as the stride for every field.  */
+
+  src.tv_sec = (time_t *) &data[0].tv_sec;
+  src.tv_nsec = (long *) &data[0].tv_nsec;
+  src.uncertainty = (float *) &data[0].uncertainty;
+  src.lat = (double *) &data[0].xy.lat;
+  src.lon = (double *) &data[0].xy.lon;
+  src.depth = (float *) &data[0].depth;
+  src.status = (uint32_t *) &data[0].status;
+  src.stride = sizeof (LLZ_REC);
+
+  encode_llz_block (layout, swap, &src, count, buf);
+}
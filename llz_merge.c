@@ -0,0 +1,516 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+/*  Parallel merge (concatenation) of llz files.  The output offset of every input file is known up front from the
+    input record counts so the output file can be filled in by several threads at once, each copying chunks of
+    records into their own part of the file with pwrite.  Records are copied byte for byte when the input file has
+    the same record layout and byte order as the output file.  Otherwise (e.g. older versions, big endian files,
+    different time or uncertainty flags, or compressed files) the scaled integer fields are moved into the output
+    layout without going through floating point so the values are exactly the same.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "llz_internal.h"
+
+
+/*  Default number of copy threads.  */
+
+#define LLZ_MERGE_THREADS 8
+#define LLZ_MERGE_MAX_THREADS 64
+
+
+/*  Number of records copied at one time (this is rounded up to whole blocks for compressed input files).  */
+
+#define LLZ_MERGE_CHUNK_RECORDS 65536
+
+
+/*  One input file.  */
+
+typedef struct
+{
+  int32_t       hnd;
+  INTERNAL_LLZ_HEADER *llz;
+  int64_t       offset;               /*!<  Output record number of the first record  */
+  int32_t       chunk_records;        /*!<  Records per copy  */
+  int64_t       chunks;               /*!<  Number of copies  */
+  uint8_t       copy;                 /*!<  Set if the records can be copied byte for byte  */
+} LLZ_MERGE_INPUT;
+
+
+/*  State shared by the copy threads.  Chunks are handed out in order (input by input) under the mutex.  */
+
+typedef struct
+{
+  pthread_mutex_t mutex;
+  LLZ_MERGE_INPUT *input;
+  int32_t       inputs;
+  INTERNAL_LLZ_HEADER *out;
+  int32_t       next_input;           /*!<  Input of the next chunk to copy  */
+  int64_t       next_chunk;           /*!<  Next chunk to copy in that input  */
+  int32_t       chunk_records;        /*!<  Largest chunk_records of any input  */
+  size_t        in_record_size;       /*!<  Largest record size of any input  */
+  uint8_t       error;
+} LLZ_MERGE;
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    same_llz_layout
+
+ - Purpose:     Check whether records can be copied from one file to
+                another without being decoded.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - in             =    The input file
+                - out            =    The output file
+
+ - Returns:
+                - 0 if the records must be converted
+                - 1
+
+********************************************************************/
+
+static uint8_t same_llz_layout (const INTERNAL_LLZ_HEADER *in, const INTERNAL_LLZ_HEADER *out)
+{
+  return (!in->compression && in->swap == out->swap && in->layout.record_size == out->layout.record_size &&
+          in->layout.time_offset == out->layout.time_offset &&
+          in->layout.uncertainty_offset == out->layout.uncertainty_offset &&
+          in->layout.lat_offset == out->layout.lat_offset && in->layout.stat_offset == out->layout.stat_offset &&
+          in->layout.stat_size == out->layout.stat_size);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_int32
+
+ - Purpose:     Get a 32 bit field from a packed record.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ptr            =    The field
+                - swap           =    Set if the field is byte swapped
+
+ - Returns:     The value
+
+********************************************************************/
+
+static inline uint32_t get_llz_int32 (const uint8_t *ptr, uint8_t swap)
+{
+  uint32_t word;
+
+
+  memcpy (&word, ptr, sizeof (uint32_t));
+
+  if (swap) word = (word >> 24) | ((word >> 8) & 0x0000ff00) | ((word << 8) & 0x00ff0000) | (word << 24);
+
+  return (word);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    put_llz_int32
+
+ - Purpose:     Store a 32 bit field in a packed record.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ptr            =    The field
+                - swap           =    Set if the field is byte swapped
+                - word           =    The value
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static inline void put_llz_int32 (uint8_t *ptr, uint8_t swap, uint32_t word)
+{
+  if (swap) word = (word >> 24) | ((word >> 8) & 0x0000ff00) | ((word << 8) & 0x00ff0000) | (word << 24);
+
+  memcpy (ptr, &word, sizeof (uint32_t));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    convert_llz_records
+
+ - Purpose:     Convert packed records from one record layout and byte
+                order to another.  The scaled integers are moved as they
+                are (they aren't converted to floating point and back)
+                so no precision is lost.  Fields that the input doesn't
+                have are set to zero.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - in_layout      =    Input record layout
+                - in_swap        =    Set if the input is byte swapped
+                - in             =    The input records
+                - count          =    Number of records
+                - out_layout     =    Output record layout
+                - out_swap       =    Set if the output is byte swapped
+                - out            =    The output records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void convert_llz_records (const LLZ_LAYOUT *in_layout, uint8_t in_swap, const uint8_t *in, int32_t count,
+                                 const LLZ_LAYOUT *out_layout, uint8_t out_swap, uint8_t *out)
+{
+  uint32_t status;
+  uint16_t stat16;
+  int32_t i, j;
+
+
+  for (i = 0 ; i < count ; i++, in += in_layout->record_size, out += out_layout->record_size)
+    {
+      if (out_layout->time_offset >= 0)
+        {
+          for (j = 0 ; j < 2 ; j++)
+            put_llz_int32 (out + out_layout->time_offset + j * 4, out_swap,
+                           in_layout->time_offset >= 0 ? get_llz_int32 (in + in_layout->time_offset + j * 4, in_swap) : 0);
+        }
+
+      if (out_layout->uncertainty_offset >= 0)
+        put_llz_int32 (out + out_layout->uncertainty_offset, out_swap,
+                       in_layout->uncertainty_offset >= 0 ? get_llz_int32 (in + in_layout->uncertainty_offset, in_swap) : 0);
+
+
+      /*  Latitude, longitude, and depth.  */
+
+      for (j = 0 ; j < 3 ; j++)
+        put_llz_int32 (out + out_layout->lat_offset + j * 4, out_swap, get_llz_int32 (in + in_layout->lat_offset + j * 4, in_swap));
+
+
+      if (in_layout->stat_size == 4)
+        {
+          status = get_llz_int32 (in + in_layout->stat_offset, in_swap);
+        }
+      else
+        {
+          memcpy (&stat16, in + in_layout->stat_offset, sizeof (uint16_t));
+          if (in_swap) stat16 = (uint16_t) ((stat16 >> 8) | (stat16 << 8));
+          status = stat16;
+        }
+
+      encode_llz_status (out_layout, out_swap, status, out + out_layout->stat_offset);
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    llz_merge_worker
+
+ - Purpose:     Copy thread.  Copies chunks of records from the input
+                files to their place in the output file until there are
+                none left or something fails.
+
+ - Date:        10/16/26
+
+ - Arguments:   arg            =    The shared merge state
+
+ - Returns:     NULL
+
+********************************************************************/
+
+static void *llz_merge_worker (void *arg)
+{
+  LLZ_MERGE *merge = (LLZ_MERGE *) arg;
+  LLZ_MERGE_INPUT *in;
+  uint8_t *in_buf, *out_buf = NULL, failed = 0;
+  int64_t chunk, start, pos;
+  int32_t count, got;
+  size_t out_size = merge->out->layout.record_size, bytes;
+
+
+  if ((in_buf = (uint8_t *) malloc ((size_t) merge->chunk_records * merge->in_record_size)) == NULL ||
+      (out_buf = (uint8_t *) malloc ((size_t) merge->chunk_records * out_size)) == NULL) failed = 1;
+
+
+  while (1)
+    {
+      /*  Get the next chunk.  */
+
+      pthread_mutex_lock (&merge->mutex);
+
+      if (failed) merge->error = 1;
+
+      while (merge->next_input < merge->inputs && merge->next_chunk >= merge->input[merge->next_input].chunks)
+        {
+          merge->next_input++;
+          merge->next_chunk = 0;
+        }
+
+      if (merge->error || merge->next_input >= merge->inputs)
+        {
+          pthread_mutex_unlock (&merge->mutex);
+          break;
+        }
+
+      in = &merge->input[merge->next_input];
+      chunk = merge->next_chunk++;
+
+      pthread_mutex_unlock (&merge->mutex);
+
+
+      start = chunk * in->chunk_records;
+      count = (int32_t) (in->llz->number_of_records64 - start < in->chunk_records ?
+                         in->llz->number_of_records64 - start : in->chunk_records);
+
+      if (in->llz->compression)
+        {
+          got = pread_llz_compressed (in->llz, start, count, in_buf);
+        }
+      else
+        {
+          bytes = pread_llz_bytes (in->llz, start * in->llz->layout.record_size + LLZ_HEADER_SIZE,
+                                   (size_t) count * in->llz->layout.record_size, in_buf);
+          got = (int32_t) (bytes / in->llz->layout.record_size);
+        }
+
+      if (got != count)
+        {
+          failed = 1;
+          continue;
+        }
+
+
+      /*  Only convert the records if we have to.  */
+
+      if (!in->copy)
+        convert_llz_records (&in->llz->layout, in->llz->swap, in_buf, count, &merge->out->layout, merge->out->swap, out_buf);
+
+      pos = (in->offset + start) * (int64_t) out_size + LLZ_HEADER_SIZE;
+
+      if (pwrite_llz_bytes (merge->out, pos, (size_t) count * out_size, in->copy ? in_buf : out_buf) != (size_t) count * out_size)
+        failed = 1;
+    }
+
+
+  if (in_buf) free (in_buf);
+  if (out_buf) free (out_buf);
+
+  return (NULL);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz
+
+ - Purpose:     Concatenate llz files into a new llz file using several
+                threads.  The output file is created with this version
+                of the library using the header (classification, source,
+                comments, depth units, etc.) of the first input file.
+                It has time and/or uncertainty if any of the input files
+                do (records from files without them get zeros).  The
+                records are in the same order as the input files.  Input
+                files that have the same record layout and byte order as
+                the output file are copied as they are, the others
+                (including compressed files) are converted exactly.
+                The output offset of each input file is known up front
+                so the threads copy chunks of records straight into
+                their place in the output file.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - in_paths       =    The llz files to merge
+                - count          =    Number of input files
+                - out_path       =    The merged llz file (must not be
+                                      one of the input files)
+                - threads        =    Number of copy threads (0 for the
+                                      default of 8)
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+uint8_t merge_llz (const char **in_paths, int32_t count, const char *out_path, int32_t threads)
+{
+  LLZ_MERGE merge;
+  LLZ_MERGE_INPUT *input;
+  LLZ_HEADER header, out_header;
+  pthread_t thread[LLZ_MERGE_MAX_THREADS];
+  int32_t i, out_hnd, started;
+  int64_t total = 0;
+  uint8_t time_flag = 0, uncertainty_flag = 0;
+
+
+  if (count <= 0) return (0);
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (!strcmp (in_paths[i], out_path)) return (0);
+    }
+
+  if (threads <= 0) threads = LLZ_MERGE_THREADS;
+  if (threads > LLZ_MERGE_MAX_THREADS) threads = LLZ_MERGE_MAX_THREADS;
+
+  if ((input = (LLZ_MERGE_INPUT *) calloc (count, sizeof (LLZ_MERGE_INPUT))) == NULL) return (0);
+
+  memset (&merge, 0, sizeof (LLZ_MERGE));
+  memset (&out_header, 0, sizeof (LLZ_HEADER));
+
+  merge.input = input;
+  merge.inputs = count;
+  merge.chunk_records = 1;
+  merge.error = 1;
+
+
+  /*  Open the input files and work out where each one goes in the output file.  */
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if ((input[i].hnd = open_llz_mmap (in_paths[i], &header)) < 0)
+        {
+          while (--i >= 0) close_llz (input[i].hnd);
+          free (input);
+          return (0);
+        }
+
+      input[i].llz = get_llz_handle (input[i].hnd);
+      input[i].offset = total;
+
+      total += input[i].llz->number_of_records64;
+
+      if (input[i].llz->time_flag) time_flag = 1;
+      if (input[i].llz->uncertainty_flag) uncertainty_flag = 1;
+      if (!i) out_header = header;
+
+      input[i].chunk_records = LLZ_MERGE_CHUNK_RECORDS;
+
+      if (input[i].llz->compression)
+        input[i].chunk_records = (LLZ_MERGE_CHUNK_RECORDS + input[i].llz->block_records - 1) / input[i].llz->block_records *
+          input[i].llz->block_records;
+
+      input[i].chunks = (input[i].llz->number_of_records64 + input[i].chunk_records - 1) / input[i].chunk_records;
+
+      if (input[i].chunk_records > merge.chunk_records) merge.chunk_records = input[i].chunk_records;
+      if (input[i].llz->layout.record_size > merge.in_record_size) merge.in_record_size = input[i].llz->layout.record_size;
+    }
+
+
+  /*  Use the flags from the handles since version 1.0 files may have garbage in the header fields.  */
+
+  out_header.time_flag = time_flag;
+  out_header.uncertainty_flag = uncertainty_flag;
+  out_header.depth_units = input[0].llz->depth_units;
+
+  if ((out_hnd = create_llz (out_path, out_header)) < 0) goto done;
+
+  merge.out = get_llz_handle (out_hnd);
+
+  for (i = 0 ; i < count ; i++) input[i].copy = same_llz_layout (input[i].llz, merge.out);
+
+
+  /*  The header was written through the FILE so flush it before we go around it.  */
+
+  fflush (merge.out->fp);
+
+  merge.error = 0;
+  pthread_mutex_init (&merge.mutex, NULL);
+
+  for (started = 0 ; started < threads ; started++)
+    {
+      if (pthread_create (&thread[started], NULL, llz_merge_worker, &merge)) break;
+    }
+
+
+  /*  If we couldn't start any threads do the copying in this one.  */
+
+  if (!started) llz_merge_worker (&merge);
+
+  for (i = 0 ; i < started ; i++) pthread_join (thread[i], NULL);
+
+  pthread_mutex_destroy (&merge.mutex);
+
+
+  /*  The records were written behind the FILE's back so the next stdio write has to seek.  */
+
+  merge.out->number_of_records64 = total;
+  sync_llz_record_count (merge.out);
+  merge.out->at_end = 0;
+
+
+  /*  The header statistics are just the combined statistics of the input files.  If any of those are unknown so
+      are the output file's (we don't read the whole output file to find them).  */
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (input[i].llz->stats_state != LLZ_STATS_CURRENT)
+        {
+          merge.out->stats_state = LLZ_STATS_UNKNOWN;
+          break;
+        }
+
+      merge_llz_stats (&merge.out->stats, &input[i].llz->stats);
+    }
+
+  close_llz (out_hnd);
+
+  if (merge.error) remove (out_path);
+
+
+ done:
+
+  for (i = 0 ; i < count ; i++) close_llz (input[i].hnd);
+
+  free (input);
+
+  return (!merge.error);
+}
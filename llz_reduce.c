@@ -0,0 +1,756 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+/*  Parallel reductions (bounding box, depth statistics, status counts, histograms, or anything else that can be
+    computed a piece at a time and combined) over a range of records.  The range is split into one contiguous
+    piece per thread.  Each thread reads its piece in chunks with pread_llz_range (so the bulk decoders are used
+    and the handle isn't disturbed) and feeds them to its own copy of the reducer state.  The states are then merged
+    in record order so that the result only depends on the number of threads, not on how they were scheduled.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "llz_internal.h"
+
+
+/*  Default and maximum number of reduction threads.  */
+
+#define LLZ_REDUCE_THREADS 8
+#define LLZ_REDUCE_MAX_THREADS 64
+
+
+/*  Number of records decoded at one time (this is rounded up to whole blocks for compressed files).  */
+
+#define LLZ_REDUCE_CHUNK_RECORDS 65536
+
+
+/*  One reduction thread.  */
+
+typedef struct
+{
+  int32_t       hnd;
+  const LLZ_REDUCER *reducer;
+  int64_t       start;                /*!<  First record of this thread's piece  */
+  int64_t       end;                  /*!<  End of this thread's piece  */
+  int32_t       chunk_records;
+  void          *state;
+  int64_t       done;                 /*!<  Number of records reduced  */
+  uint8_t       error;
+} LLZ_REDUCE_THREAD;
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    llz_reduce_worker
+
+ - Purpose:     Reduce one thread's piece of the record range.
+
+ - Date:        10/16/26
+
+ - Arguments:   arg            =    The LLZ_REDUCE_THREAD
+
+ - Returns:     NULL
+
+********************************************************************/
+
+static void *llz_reduce_worker (void *arg)
+{
+  LLZ_REDUCE_THREAD *thread = (LLZ_REDUCE_THREAD *) arg;
+  LLZ_REC *data;
+  int64_t recnum;
+  int32_t num, got;
+
+
+  if ((data = (LLZ_REC *) malloc ((size_t) thread->chunk_records * sizeof (LLZ_REC))) == NULL)
+    {
+      thread->error = 1;
+      return (NULL);
+    }
+
+  for (recnum = thread->start ; recnum < thread->end ; recnum += got)
+    {
+      num = (int32_t) (thread->end - recnum < thread->chunk_records ? thread->end - recnum : thread->chunk_records);
+
+      if ((got = pread_llz_range (thread->hnd, recnum, num, data)) != num)
+        {
+          thread->error = 1;
+          break;
+        }
+
+      (*thread->reducer->reduce) (thread->state, recnum, got, data, thread->reducer->param);
+
+      thread->done += got;
+    }
+
+  free (data);
+
+  return (NULL);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    reduce_llz
+
+ - Purpose:     Run a reducer over a range of records using several
+                threads.  The range is split into one contiguous piece
+                per thread, each piece is decoded in large chunks and
+                reduced into the thread's own state, and the states are
+                merged in record order into result.  Use one of the
+                built in reducers (llz_bbox_reducer, llz_depth_reducer,
+                llz_status_reducer, or llz_histogram_reducer) or supply
+                your own.  The reduce function is called from several
+                threads at once (with different states) so it must not
+                change anything but its state.  Don't append or update
+                records on the handle while this is running.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The first record
+                - count          =    The number of records (-1 for the
+                                      rest of the file)
+                - reducer        =    The reducer
+                - result         =    The merged result (reducer->state_size
+                                      bytes, e.g. an LLZ_BBOX for
+                                      llz_bbox_reducer)
+                - threads        =    Number of threads (0 for the default
+                                      of 8)
+
+ - Returns:
+                - The number of records reduced
+                - -1 on error
+
+********************************************************************/
+
+int64_t reduce_llz (int32_t hnd, int64_t start, int64_t count, const LLZ_REDUCER *reducer, void *result, int32_t threads)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  LLZ_REDUCE_THREAD thread[LLZ_REDUCE_MAX_THREADS];
+  pthread_t id[LLZ_REDUCE_MAX_THREADS];
+  uint8_t started[LLZ_REDUCE_MAX_THREADS], *states;
+  int64_t n, chunks, per_thread, total = 0;
+  int32_t chunk_records = LLZ_REDUCE_CHUNK_RECORDS, i;
+  uint8_t error = 0;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL || reducer == NULL || result == NULL || !reducer->state_size ||
+      reducer->init == NULL || reducer->reduce == NULL || reducer->merge == NULL) return (-1);
+
+  n = llz->number_of_records64;
+
+  if (start < 0 || start > n) return (-1);
+
+  if (count < 0 || count > n - start) count = n - start;
+
+
+  /*  Compressed files are decompressed a whole block at a time so don't split blocks between chunks.  */
+
+  if (llz->compression)
+    chunk_records = (LLZ_REDUCE_CHUNK_RECORDS + llz->block_records - 1) / llz->block_records * llz->block_records;
+
+  if (threads <= 0) threads = LLZ_REDUCE_THREADS;
+  if (threads > LLZ_REDUCE_MAX_THREADS) threads = LLZ_REDUCE_MAX_THREADS;
+
+
+  /*  Give each thread a whole number of chunks (but at least one chunk).  The pieces start on chunk boundaries
+      relative to record 0 so that compressed blocks line up.  */
+
+  chunks = ((start + count + chunk_records - 1) / chunk_records) - start / chunk_records;
+  if (threads > chunks) threads = (int32_t) (chunks ? chunks : 1);
+  per_thread = (chunks + threads - 1) / threads;
+
+  if ((states = (uint8_t *) malloc ((size_t) threads * reducer->state_size)) == NULL) return (-1);
+
+  for (i = 0 ; i < threads ; i++)
+    {
+      thread[i].hnd = hnd;
+      thread[i].reducer = reducer;
+      thread[i].start = (start / chunk_records + i * per_thread) * chunk_records;
+      thread[i].end = thread[i].start + per_thread * chunk_records;
+      thread[i].chunk_records = chunk_records;
+      thread[i].state = states + (size_t) i * reducer->state_size;
+      thread[i].done = 0;
+      thread[i].error = 0;
+
+      if (thread[i].start < start) thread[i].start = start;
+      if (thread[i].end > start + count) thread[i].end = start + count;
+      if (thread[i].start > thread[i].end) thread[i].start = thread[i].end;
+
+      (*reducer->init) (thread[i].state, reducer->param);
+    }
+
+
+  /*  The last piece is done in this thread.  */
+
+  for (i = 0 ; i < threads - 1 ; i++) started[i] = !pthread_create (&id[i], NULL, llz_reduce_worker, &thread[i]);
+
+  llz_reduce_worker (&thread[threads - 1]);
+
+  for (i = 0 ; i < threads - 1 ; i++)
+    {
+      if (started[i])
+        {
+          pthread_join (id[i], NULL);
+        }
+      else
+        {
+          llz_reduce_worker (&thread[i]);
+        }
+    }
+
+
+  /*  Merge the states in record order.  */
+
+  memcpy (result, states, reducer->state_size);
+
+  for (i = 0 ; i < threads ; i++)
+    {
+      if (i) (*reducer->merge) (result, thread[i].state, reducer->param);
+
+      if (thread[i].error) error = 1;
+      total += thread[i].done;
+    }
+
+  if (reducer->finish) (*reducer->finish) (result, reducer->param);
+
+  free (states);
+
+  if (error) return (-1);
+
+  return (total);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    init_llz_bbox
+
+ - Purpose:     Start an empty LLZ_BBOX.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_BBOX
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void init_llz_bbox (void *state, const void *param)
+{
+  LLZ_BBOX *bbox = (LLZ_BBOX *) state;
+
+  memset (bbox, 0, sizeof (LLZ_BBOX));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    reduce_llz_bbox
+
+ - Purpose:     Add a batch of records to an LLZ_BBOX.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_BBOX
+                - start          =    Record number of the first record
+                - count          =    Number of records
+                - data           =    The records
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void reduce_llz_bbox (void *state, int64_t start, int32_t count, const LLZ_REC *data, const void *param)
+{
+  LLZ_BBOX *bbox = (LLZ_BBOX *) state;
+  int32_t i;
+
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (data[i].status & LLZ_INVAL) continue;
+
+      if (!bbox->count)
+        {
+          bbox->min_lat = bbox->max_lat = data[i].xy.lat;
+          bbox->min_lon = bbox->max_lon = data[i].xy.lon;
+        }
+      else
+        {
+          if (data[i].xy.lat < bbox->min_lat) bbox->min_lat = data[i].xy.lat;
+          if (data[i].xy.lat > bbox->max_lat) bbox->max_lat = data[i].xy.lat;
+          if (data[i].xy.lon < bbox->min_lon) bbox->min_lon = data[i].xy.lon;
+          if (data[i].xy.lon > bbox->max_lon) bbox->max_lon = data[i].xy.lon;
+        }
+
+      bbox->count++;
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz_bbox
+
+ - Purpose:     Add one LLZ_BBOX to another.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_BBOX
+                - other          =    The LLZ_BBOX to add
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void merge_llz_bbox (void *state, const void *other, const void *param)
+{
+  LLZ_BBOX *bbox = (LLZ_BBOX *) state;
+  const LLZ_BBOX *add = (const LLZ_BBOX *) other;
+
+
+  if (!add->count) return;
+
+  if (!bbox->count)
+    {
+      *bbox = *add;
+      return;
+    }
+
+  if (add->min_lat < bbox->min_lat) bbox->min_lat = add->min_lat;
+  if (add->max_lat > bbox->max_lat) bbox->max_lat = add->max_lat;
+  if (add->min_lon < bbox->min_lon) bbox->min_lon = add->min_lon;
+  if (add->max_lon > bbox->max_lon) bbox->max_lon = add->max_lon;
+
+  bbox->count += add->count;
+}
+
+
+const LLZ_REDUCER llz_bbox_reducer = {sizeof (LLZ_BBOX), init_llz_bbox, reduce_llz_bbox, merge_llz_bbox, NULL, NULL};
+
+
+/********************************************************************/
+/*!
+
+ - Function:    init_llz_depth
+
+ - Purpose:     Start an empty LLZ_DEPTH_STATS.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_DEPTH_STATS
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void init_llz_depth (void *state, const void *param)
+{
+  LLZ_DEPTH_STATS *stats = (LLZ_DEPTH_STATS *) state;
+
+  memset (stats, 0, sizeof (LLZ_DEPTH_STATS));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    reduce_llz_depth
+
+ - Purpose:     Add a batch of records to an LLZ_DEPTH_STATS.  The
+                mean and variance are accumulated with Welford's method
+                so that they stay accurate for very large numbers of
+                records.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_DEPTH_STATS
+                - start          =    Record number of the first record
+                - count          =    Number of records
+                - data           =    The records
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void reduce_llz_depth (void *state, int64_t start, int32_t count, const LLZ_REC *data, const void *param)
+{
+  LLZ_DEPTH_STATS *stats = (LLZ_DEPTH_STATS *) state;
+  double delta;
+  int32_t i;
+
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (data[i].status & LLZ_INVAL) continue;
+
+      if (!stats->count)
+        {
+          stats->min_depth = stats->max_depth = data[i].depth;
+        }
+      else
+        {
+          if (data[i].depth < stats->min_depth) stats->min_depth = data[i].depth;
+          if (data[i].depth > stats->max_depth) stats->max_depth = data[i].depth;
+        }
+
+      stats->count++;
+
+      delta = (double) data[i].depth - stats->mean;
+      stats->mean += delta / (double) stats->count;
+      stats->m2 += delta * ((double) data[i].depth - stats->mean);
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz_depth
+
+ - Purpose:     Add one LLZ_DEPTH_STATS to another (using Chan's
+                method for the mean and variance).
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_DEPTH_STATS
+                - other          =    The LLZ_DEPTH_STATS to add
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void merge_llz_depth (void *state, const void *other, const void *param)
+{
+  LLZ_DEPTH_STATS *stats = (LLZ_DEPTH_STATS *) state;
+  const LLZ_DEPTH_STATS *add = (const LLZ_DEPTH_STATS *) other;
+  double delta, count;
+
+
+  if (!add->count) return;
+
+  if (!stats->count)
+    {
+      *stats = *add;
+      return;
+    }
+
+  if (add->min_depth < stats->min_depth) stats->min_depth = add->min_depth;
+  if (add->max_depth > stats->max_depth) stats->max_depth = add->max_depth;
+
+  count = (double) (stats->count + add->count);
+  delta = add->mean - stats->mean;
+
+  stats->mean += delta * (double) add->count / count;
+  stats->m2 += add->m2 + delta * delta * (double) stats->count * (double) add->count / count;
+  stats->count += add->count;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    finish_llz_depth
+
+ - Purpose:     Compute the variance of an LLZ_DEPTH_STATS.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_DEPTH_STATS
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void finish_llz_depth (void *state, const void *param)
+{
+  LLZ_DEPTH_STATS *stats = (LLZ_DEPTH_STATS *) state;
+
+  stats->variance = stats->count ? stats->m2 / (double) stats->count : 0.0;
+}
+
+
+const LLZ_REDUCER llz_depth_reducer = {sizeof (LLZ_DEPTH_STATS), init_llz_depth, reduce_llz_depth, merge_llz_depth,
+                                       finish_llz_depth, NULL};
+
+
+/********************************************************************/
+/*!
+
+ - Function:    init_llz_status
+
+ - Purpose:     Start an empty LLZ_STATUS_COUNTS.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_STATUS_COUNTS
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void init_llz_status (void *state, const void *param)
+{
+  LLZ_STATUS_COUNTS *counts = (LLZ_STATUS_COUNTS *) state;
+
+  memset (counts, 0, sizeof (LLZ_STATUS_COUNTS));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    reduce_llz_status
+
+ - Purpose:     Add a batch of records to an LLZ_STATUS_COUNTS.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_STATUS_COUNTS
+                - start          =    Record number of the first record
+                - count          =    Number of records
+                - data           =    The records
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void reduce_llz_status (void *state, int64_t start, int32_t count, const LLZ_REC *data, const void *param)
+{
+  LLZ_STATUS_COUNTS *counts = (LLZ_STATUS_COUNTS *) state;
+  int32_t i;
+
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (!(data[i].status & LLZ_INVAL)) counts->valid++;
+      if (data[i].status & LLZ_MANUALLY_INVAL) counts->manually_invalid++;
+      if (data[i].status & LLZ_FILTER_INVAL) counts->filter_invalid++;
+    }
+
+  counts->total += count;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz_status
+
+ - Purpose:     Add one LLZ_STATUS_COUNTS to another.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_STATUS_COUNTS
+                - other          =    The LLZ_STATUS_COUNTS to add
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void merge_llz_status (void *state, const void *other, const void *param)
+{
+  LLZ_STATUS_COUNTS *counts = (LLZ_STATUS_COUNTS *) state;
+  const LLZ_STATUS_COUNTS *add = (const LLZ_STATUS_COUNTS *) other;
+
+
+  counts->total += add->total;
+  counts->valid += add->valid;
+  counts->manually_invalid += add->manually_invalid;
+  counts->filter_invalid += add->filter_invalid;
+}
+
+
+const LLZ_REDUCER llz_status_reducer = {sizeof (LLZ_STATUS_COUNTS), init_llz_status, reduce_llz_status, merge_llz_status,
+                                        NULL, NULL};
+
+
+/********************************************************************/
+/*!
+
+ - Function:    init_llz_histogram
+
+ - Purpose:     Start an empty LLZ_DEPTH_HISTOGRAM with the depth range
+                and number of bins from param.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_DEPTH_HISTOGRAM
+                - param          =    LLZ_DEPTH_HISTOGRAM with min_depth,
+                                      max_depth, and bins set
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void init_llz_histogram (void *state, const void *param)
+{
+  LLZ_DEPTH_HISTOGRAM *histogram = (LLZ_DEPTH_HISTOGRAM *) state;
+  const LLZ_DEPTH_HISTOGRAM *range = (const LLZ_DEPTH_HISTOGRAM *) param;
+
+
+  memset (histogram, 0, sizeof (LLZ_DEPTH_HISTOGRAM));
+
+  if (range == NULL) return;
+
+  histogram->min_depth = range->min_depth;
+  histogram->max_depth = range->max_depth;
+  histogram->bins = range->bins;
+
+  if (histogram->bins < 1) histogram->bins = 1;
+  if (histogram->bins > LLZ_HISTOGRAM_BINS) histogram->bins = LLZ_HISTOGRAM_BINS;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    reduce_llz_histogram
+
+ - Purpose:     Add a batch of records to an LLZ_DEPTH_HISTOGRAM.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_DEPTH_HISTOGRAM
+                - start          =    Record number of the first record
+                - count          =    Number of records
+                - data           =    The records
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void reduce_llz_histogram (void *state, int64_t start, int32_t count, const LLZ_REC *data, const void *param)
+{
+  LLZ_DEPTH_HISTOGRAM *histogram = (LLZ_DEPTH_HISTOGRAM *) state;
+  double scale = 0.0;
+  int32_t i, bin;
+
+
+  if (histogram->max_depth > histogram->min_depth)
+    scale = (double) histogram->bins / (histogram->max_depth - histogram->min_depth);
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (data[i].status & LLZ_INVAL) continue;
+
+      if (data[i].depth < histogram->min_depth)
+        {
+          histogram->below++;
+        }
+      else if (data[i].depth >= histogram->max_depth)
+        {
+          histogram->above++;
+        }
+      else
+        {
+          bin = (int32_t) (((double) data[i].depth - histogram->min_depth) * scale);
+          if (bin >= histogram->bins) bin = histogram->bins - 1;
+
+          histogram->count[bin]++;
+        }
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz_histogram
+
+ - Purpose:     Add one LLZ_DEPTH_HISTOGRAM to another.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - state          =    The LLZ_DEPTH_HISTOGRAM
+                - other          =    The LLZ_DEPTH_HISTOGRAM to add
+                - param          =    Not used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void merge_llz_histogram (void *state, const void *other, const void *param)
+{
+  LLZ_DEPTH_HISTOGRAM *histogram = (LLZ_DEPTH_HISTOGRAM *) state;
+  const LLZ_DEPTH_HISTOGRAM *add = (const LLZ_DEPTH_HISTOGRAM *) other;
+  int32_t i;
+
+
+  histogram->below += add->below;
+  histogram->above += add->above;
+
+  for (i = 0 ; i < histogram->bins ; i++) histogram->count[i] += add->count[i];
+}
+
+
+const LLZ_REDUCER llz_histogram_reducer = {sizeof (LLZ_DEPTH_HISTOGRAM), init_llz_histogram, reduce_llz_histogram,
+                                           merge_llz_histogram, NULL, NULL};
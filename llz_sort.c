@@ -0,0 +1,711 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Out-of-core spatial sort of llz files.  The packed records are copied byte for byte (they're never decoded and
+    re-encoded) so the sorted file has exactly the same header, version, flags, and values as the original.  Runs
+    of up to LLZ_SORT_RUN_RECORDS records are sorted in memory and written to temporary files next to the output
+    file which are then merged (in more than one pass if there are a lot of them).  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "llz_internal.h"
+
+
+/*  Number of records sorted in memory at one time.  */
+
+#define LLZ_SORT_RUN_RECORDS 2097152
+
+
+/*  Maximum number of runs merged at once (this limits the number of open files).  */
+
+#define LLZ_SORT_MERGE_RUNS 128
+
+
+/*  Number of records read from the input file at one time and buffered for each run while merging.  */
+
+#define LLZ_SORT_READ_RECORDS 65536
+#define LLZ_SORT_RUN_BUFFER 4096
+
+
+/*  Sort key and position of a record within the in-memory run.  */
+
+typedef struct
+{
+  uint64_t      key;
+  int64_t       index;
+} LLZ_SORT_KEY;
+
+
+/*  A sorted run that is being merged.  Each entry in a run file is the 64 bit key followed by the packed record.  */
+
+typedef struct
+{
+  FILE          *fp;
+  char          *path;
+  uint8_t       *buffer;
+  int32_t       count;                /*!<  Entries in buffer  */
+  int32_t       next;                 /*!<  Next entry in buffer  */
+} LLZ_SORT_RUN;
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    hilbert_llz_key
+
+ - Purpose:     Compute the distance along a Hilbert curve that fills
+                the full 32 bit by 32 bit square.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - x              =    X coordinate
+                - y              =    Y coordinate
+
+ - Returns:     The Hilbert curve distance
+
+********************************************************************/
+
+static uint64_t hilbert_llz_key (uint32_t x, uint32_t y)
+{
+  uint64_t d = 0;
+  uint32_t s, rx, ry, t;
+
+
+  for (s = 0x80000000u ; s ; s >>= 1)
+    {
+      rx = (x & s) ? 1 : 0;
+      ry = (y & s) ? 1 : 0;
+
+      d += (uint64_t) s * (uint64_t) s * (uint64_t) ((3 * rx) ^ ry);
+
+
+      /*  Rotate the quadrant.  */
+
+      if (!ry)
+        {
+          if (rx)
+            {
+              x = ~x;
+              y = ~y;
+            }
+
+          t = x;
+          x = y;
+          y = t;
+        }
+    }
+
+  return (d);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    morton_llz_key
+
+ - Purpose:     Compute the Z-order (Morton) key by interleaving the
+                bits of x and y.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - x              =    X coordinate
+                - y              =    Y coordinate
+
+ - Returns:     The Morton key
+
+********************************************************************/
+
+static uint64_t morton_llz_key (uint32_t x, uint32_t y)
+{
+  uint64_t kx = x, ky = y;
+
+
+  kx = (kx | (kx << 16)) & 0x0000ffff0000ffffULL;
+  kx = (kx | (kx << 8)) & 0x00ff00ff00ff00ffULL;
+  kx = (kx | (kx << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  kx = (kx | (kx << 2)) & 0x3333333333333333ULL;
+  kx = (kx | (kx << 1)) & 0x5555555555555555ULL;
+
+  ky = (ky | (ky << 16)) & 0x0000ffff0000ffffULL;
+  ky = (ky | (ky << 8)) & 0x00ff00ff00ff00ffULL;
+  ky = (ky | (ky << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  ky = (ky | (ky << 2)) & 0x3333333333333333ULL;
+  ky = (ky | (ky << 1)) & 0x5555555555555555ULL;
+
+  return ((ky << 1) | kx);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    compare_llz_sort_key
+
+ - Purpose:     qsort comparison function for LLZ_SORT_KEY.  Ties are
+                broken by position so the sort is stable.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - a              =    First key
+                - b              =    Second key
+
+ - Returns:     -1, 0, or 1
+
+********************************************************************/
+
+static int32_t compare_llz_sort_key (const void *a, const void *b)
+{
+  const LLZ_SORT_KEY *ka = (const LLZ_SORT_KEY *) a;
+  const LLZ_SORT_KEY *kb = (const LLZ_SORT_KEY *) b;
+
+
+  if (ka->key < kb->key) return (-1);
+  if (ka->key > kb->key) return (1);
+  if (ka->index < kb->index) return (-1);
+  if (ka->index > kb->index) return (1);
+
+  return (0);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_run_path
+
+ - Purpose:     Build the name of a temporary run file.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - path           =    The output llz file path
+                - run            =    Run number
+
+ - Returns:
+                - The run file path (free it when done) or NULL on error
+
+********************************************************************/
+
+static char *get_llz_run_path (const char *path, int32_t run)
+{
+  char *run_path;
+
+
+  if ((run_path = (char *) malloc (strlen (path) + 32)) == NULL) return (NULL);
+
+  sprintf (run_path, "%s.sort%d", path, run);
+
+  return (run_path);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    fill_llz_run
+
+ - Purpose:     Refill the buffer of a run that is being merged.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - run            =    The run
+                - entry_size     =    Size of a key and packed record
+
+ - Returns:     The number of entries in the buffer (0 at end of run)
+
+********************************************************************/
+
+static int32_t fill_llz_run (LLZ_SORT_RUN *run, size_t entry_size)
+{
+  run->count = (int32_t) fread (run->buffer, entry_size, LLZ_SORT_RUN_BUFFER, run->fp);
+  run->next = 0;
+
+  return (run->count);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    run_llz_key
+
+ - Purpose:     Get the key of the next entry in a run.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - run            =    The run
+                - entry_size     =    Size of a key and packed record
+
+ - Returns:     The key
+
+********************************************************************/
+
+static uint64_t run_llz_key (const LLZ_SORT_RUN *run, size_t entry_size)
+{
+  uint64_t key;
+
+
+  memcpy (&key, run->buffer + (size_t) run->next * entry_size, sizeof (uint64_t));
+
+  return (key);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    sift_llz_heap
+
+ - Purpose:     Move a run down the merge heap to where it belongs.  The
+                heap is ordered by the next key in each run and then by
+                run number so that the merge is stable.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - run            =    The runs
+                - heap           =    The heap of run numbers
+                - n              =    Number of runs in the heap
+                - i              =    Heap position to sift down
+                - entry_size     =    Size of a key and packed record
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void sift_llz_heap (const LLZ_SORT_RUN *run, int32_t *heap, int32_t n, int32_t i, size_t entry_size)
+{
+  int32_t top = heap[i], child;
+  uint64_t key, child_key, right_key;
+
+
+  key = run_llz_key (&run[top], entry_size);
+
+  while ((child = 2 * i + 1) < n)
+    {
+      child_key = run_llz_key (&run[heap[child]], entry_size);
+
+      if (child + 1 < n)
+        {
+          right_key = run_llz_key (&run[heap[child + 1]], entry_size);
+
+          if (right_key < child_key || (right_key == child_key && heap[child + 1] < heap[child]))
+            {
+              child++;
+              child_key = right_key;
+            }
+        }
+
+      if (key < child_key || (key == child_key && top < heap[child])) break;
+
+      heap[i] = heap[child];
+      i = child;
+    }
+
+  heap[i] = top;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz_runs
+
+ - Purpose:     Merge sorted runs into a single sorted stream.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - run            =    The runs (open and positioned at the
+                                      start)
+                - count          =    Number of runs
+                - record_size    =    Size of a packed record
+                - fp             =    The output file
+                - keys           =    If set, write the keys too (i.e. we
+                                      are writing another run file)
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+static uint8_t merge_llz_runs (LLZ_SORT_RUN *run, int32_t count, size_t record_size, FILE *fp, uint8_t keys)
+{
+  int32_t heap[LLZ_SORT_MERGE_RUNS], n, i, top;
+  size_t entry_size = sizeof (uint64_t) + record_size;
+  const uint8_t *entry;
+
+
+  for (i = n = 0 ; i < count ; i++)
+    {
+      if (fill_llz_run (&run[i], entry_size)) heap[n++] = i;
+    }
+
+  for (i = n / 2 - 1 ; i >= 0 ; i--) sift_llz_heap (run, heap, n, i, entry_size);
+
+
+  while (n)
+    {
+      top = heap[0];
+      entry = run[top].buffer + (size_t) run[top].next * entry_size;
+
+      if (keys)
+        {
+          if (fwrite (entry, entry_size, 1, fp) != 1) return (0);
+        }
+      else
+        {
+          if (fwrite (entry + sizeof (uint64_t), record_size, 1, fp) != 1) return (0);
+        }
+
+
+      /*  Advance the run (dropping it from the heap when it's empty) and put the heap back in order.  */
+
+      if (++run[top].next == run[top].count && !fill_llz_run (&run[top], entry_size))
+        {
+          heap[0] = heap[--n];
+        }
+
+      if (n) sift_llz_heap (run, heap, n, 0, entry_size);
+    }
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz_run_files
+
+ - Purpose:     Merge a group of run files, then delete them.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - path           =    The run file paths (these are freed)
+                - count          =    Number of runs
+                - record_size    =    Size of a packed record
+                - fp             =    The output file
+                - keys           =    If set, write the keys too
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+static uint8_t merge_llz_run_files (char **path, int32_t count, size_t record_size, FILE *fp, uint8_t keys)
+{
+  LLZ_SORT_RUN run[LLZ_SORT_MERGE_RUNS];
+  size_t entry_size = sizeof (uint64_t) + record_size;
+  int32_t i;
+  uint8_t status = 1;
+
+
+  memset (run, 0, sizeof (run));
+
+  for (i = 0 ; i < count ; i++)
+    {
+      run[i].path = path[i];
+
+      if ((run[i].fp = fopen64 (path[i], "rb")) == NULL ||
+          (run[i].buffer = (uint8_t *) malloc (LLZ_SORT_RUN_BUFFER * entry_size)) == NULL) status = 0;
+    }
+
+  if (status) status = merge_llz_runs (run, count, record_size, fp, keys);
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (run[i].fp) fclose (run[i].fp);
+      if (run[i].buffer) free (run[i].buffer);
+
+      remove (run[i].path);
+      free (run[i].path);
+      path[i] = NULL;
+    }
+
+  return (status);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    sort_llz
+
+ - Purpose:     Write a copy of an llz file with the records sorted
+                along a Hilbert or Z-order (Morton) curve over latitude
+                and longitude.  Points that are close together on the
+                ground end up close together in the file so reading a
+                small area (e.g. with read_llz_bbox after building an
+                index with create_llz_index) touches far fewer pages.
+                The header and the packed records are copied exactly so
+                the version, flags, and values are unchanged.  Records
+                with the same curve position keep their original order.
+                The sort is done out of core using temporary files named
+                <out_path>.sort<N> so files larger than memory can be
+                sorted.  Compressed files can't be sorted.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - in_path        =    The llz file to sort
+                - out_path       =    The sorted llz file (must not be the
+                                      same file as in_path)
+                - order          =    LLZ_HILBERT_ORDER or LLZ_MORTON_ORDER
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+uint8_t sort_llz (const char *in_path, const char *out_path, int32_t order)
+{
+  LLZ_HEADER header;
+  INTERNAL_LLZ_HEADER *llz;
+  LLZ_RAW raw;
+  LLZ_SORT_KEY *key = NULL;
+  uint8_t *records = NULL, *text = NULL, status = 0;
+  char **path = NULL, **new_path;
+  int64_t n, start, run_records, i;
+  int32_t hnd, runs = 0, slots = 0, next_run = 0, num, j, k, groups;
+  size_t record_size;
+  uint32_t x, y;
+  FILE *in, *fp = NULL;
+
+
+  if (!strcmp (in_path, out_path)) return (0);
+
+  if ((hnd = open_llz_mmap (in_path, &header)) < 0) return (0);
+
+  llz = get_llz_handle (hnd);
+  record_size = llz->layout.record_size;
+  n = llz->number_of_records64;
+
+
+  /*  The records of a compressed file can't be copied as they are.  */
+
+  if (llz->compressed)
+    {
+      close_llz (hnd);
+      return (0);
+    }
+
+  run_records = n < LLZ_SORT_RUN_RECORDS ? n : LLZ_SORT_RUN_RECORDS;
+  if (!run_records) run_records = 1;
+
+
+  /*  Get the header exactly as it is in the input file.  */
+
+  if ((text = (uint8_t *) malloc (LLZ_HEADER_SIZE)) == NULL || (in = fopen64 (in_path, "rb")) == NULL) goto done;
+
+  j = (int32_t) fread (text, LLZ_HEADER_SIZE, 1, in);
+  fclose (in);
+
+  if (j != 1) goto done;
+
+
+  if ((key = (LLZ_SORT_KEY *) malloc ((size_t) run_records * sizeof (LLZ_SORT_KEY))) == NULL ||
+      (records = (uint8_t *) malloc ((size_t) run_records * record_size)) == NULL) goto done;
+
+
+  /*  Nothing to sort.  */
+
+  if (!n)
+    {
+      if ((fp = fopen64 (out_path, "wb")) != NULL && fwrite (text, LLZ_HEADER_SIZE, 1, fp) == 1) status = 1;
+      goto done;
+    }
+
+
+  /*  Sort each run in memory.  If everything fits in one run it goes straight to the output file, otherwise it
+      goes to a run file.  */
+
+  for (start = 0 ; start < n ; start += run_records)
+    {
+      num = (int32_t) (n - start < run_records ? n - start : run_records);
+
+      for (i = 0 ; i < num ; i += raw.count)
+        {
+          if (read_llz_raw (hnd, start + i, (int32_t) (num - i < LLZ_SORT_READ_RECORDS ? num - i : LLZ_SORT_READ_RECORDS), &raw) <= 0) goto done;
+
+          memcpy (records + (size_t) i * record_size, raw.data, (size_t) raw.count * record_size);
+
+          for (k = 0 ; k < raw.count ; k++)
+            {
+              /*  Flip the sign bits so that the unsigned coordinates sort the same way as the signed values.  */
+
+              x = (uint32_t) llz_raw_int32 (&raw, k, raw.lon_offset) ^ 0x80000000u;
+              y = (uint32_t) llz_raw_int32 (&raw, k, raw.lat_offset) ^ 0x80000000u;
+
+              key[i + k].key = (order == LLZ_MORTON_ORDER) ? morton_llz_key (x, y) : hilbert_llz_key (x, y);
+              key[i + k].index = i + k;
+            }
+        }
+
+      qsort (key, num, sizeof (LLZ_SORT_KEY), compare_llz_sort_key);
+
+
+      if (n <= run_records)
+        {
+          if ((fp = fopen64 (out_path, "wb")) == NULL || fwrite (text, LLZ_HEADER_SIZE, 1, fp) != 1) goto done;
+
+          for (i = 0 ; i < num ; i++)
+            {
+              if (fwrite (records + (size_t) key[i].index * record_size, record_size, 1, fp) != 1) goto done;
+            }
+
+          status = 1;
+          goto done;
+        }
+
+
+      if ((new_path = (char **) realloc (path, (runs + 1) * sizeof (char *))) == NULL) goto done;
+      path = new_path;
+      slots = runs + 1;
+
+      if ((path[runs] = get_llz_run_path (out_path, next_run++)) == NULL) goto done;
+      runs++;
+
+      if ((fp = fopen64 (path[runs - 1], "wb")) == NULL) goto done;
+
+      for (i = 0 ; i < num ; i++)
+        {
+          if (fwrite (&key[i].key, sizeof (uint64_t), 1, fp) != 1 ||
+              fwrite (records + (size_t) key[i].index * record_size, record_size, 1, fp) != 1) goto done;
+        }
+
+      if (fclose (fp)) goto done;
+      fp = NULL;
+    }
+
+  free (key);
+  free (records);
+  key = NULL;
+  records = NULL;
+
+  close_llz (hnd);
+  hnd = -1;
+
+
+  /*  Merge groups of runs into bigger runs until there are few enough to merge into the output file at once.
+      The groups are merged in order so that the sort stays stable.  */
+
+  while (runs > LLZ_SORT_MERGE_RUNS)
+    {
+      groups = (runs + LLZ_SORT_MERGE_RUNS - 1) / LLZ_SORT_MERGE_RUNS;
+
+      for (j = 0 ; j < groups ; j++)
+        {
+          k = runs - j * LLZ_SORT_MERGE_RUNS;
+          if (k > LLZ_SORT_MERGE_RUNS) k = LLZ_SORT_MERGE_RUNS;
+
+          if (slots < runs + 1)
+            {
+              if ((new_path = (char **) realloc (path, (runs + 1) * sizeof (char *))) == NULL) goto done;
+              path = new_path;
+              slots = runs + 1;
+            }
+
+          if ((path[runs] = get_llz_run_path (out_path, next_run++)) == NULL || (fp = fopen64 (path[runs], "wb")) == NULL)
+            goto done;
+
+          if (!merge_llz_run_files (&path[j * LLZ_SORT_MERGE_RUNS], k, record_size, fp, 1)) goto done;
+
+          if (fclose (fp)) goto done;
+          fp = NULL;
+
+
+          /*  Keep the merged run where the group was.  */
+
+          path[j] = path[runs];
+          path[runs] = NULL;
+        }
+
+      for (j = groups ; j < slots ; j++) path[j] = NULL;
+      runs = groups;
+    }
+
+
+  if ((fp = fopen64 (out_path, "wb")) == NULL || fwrite (text, LLZ_HEADER_SIZE, 1, fp) != 1) goto done;
+
+  status = merge_llz_run_files (path, runs, record_size, fp, 0);
+
+
+ done:
+
+  if (fp && fclose (fp)) status = 0;
+
+  if (hnd >= 0) close_llz (hnd);
+
+  for (j = 0 ; j < slots ; j++)
+    {
+      if (path[j])
+        {
+          remove (path[j]);
+          free (path[j]);
+        }
+    }
+
+  if (path) free (path);
+  if (key) free (key);
+  if (records) free (records);
+  if (text) free (text);
+
+  if (!status) remove (out_path);
+
+
+  /*  Any index for the output file is for some other file.  */
+
+  remove_llz_index (out_path);
+
+  return (status);
+}
@@ -0,0 +1,407 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+/*  Statistics of the valid records (extents and valid count) that are kept in the llz header so that programs
+    that only need to know the extent of a file don't have to read every record.  They are maintained as records
+    are appended or updated using the scaled integers from the packed records so they are always exact.  If a valid
+    record that was on the edge of the extents is changed or invalidated the extents can't be shrunk without
+    looking at every record, so the statistics become unknown.  Unknown statistics are dropped from the header
+    rather than rescanned when the file is closed (an edit of a few records shouldn't cost a read of the whole
+    file).  They're only rescanned if get_llz_stats asks for them.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "llz_internal.h"
+
+
+/*  Number of records read at one time when rescanning.  */
+
+#define LLZ_STATS_CHUNK_RECORDS 65536
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_stats_field
+
+ - Purpose:     Get a 32 bit field from a packed record.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - ptr            =    The field
+                - swap           =    Set if the field is byte swapped
+
+ - Returns:     The value
+
+********************************************************************/
+
+static inline int32_t get_llz_stats_field (const uint8_t *ptr, uint8_t swap)
+{
+  uint32_t word;
+
+
+  memcpy (&word, ptr, sizeof (uint32_t));
+
+  if (swap) word = (word >> 24) | ((word >> 8) & 0x0000ff00) | ((word << 8) & 0x00ff0000) | (word << 24);
+
+  return ((int32_t) word);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    llz_record_valid
+
+ - Purpose:     Check the status of a packed record for LLZ_INVAL bits.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    Record layout
+                - swap           =    Set if the record is byte swapped
+                - rec            =    The packed record
+
+ - Returns:
+                - 0 if the record is invalid
+                - 1
+
+********************************************************************/
+
+static inline uint8_t llz_record_valid (const LLZ_LAYOUT *layout, uint8_t swap, const uint8_t *rec)
+{
+  uint16_t stat16;
+
+
+  if (layout->stat_size == 4) return (!(get_llz_stats_field (rec + layout->stat_offset, swap) & LLZ_INVAL));
+
+  memcpy (&stat16, rec + layout->stat_offset, sizeof (uint16_t));
+  if (swap) stat16 = (uint16_t) ((stat16 >> 8) | (stat16 << 8));
+
+  return (!(stat16 & LLZ_INVAL));
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    add_llz_stats
+
+ - Purpose:     Add packed records that have just been written to the
+                header statistics.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - rec            =    The packed records
+                - count          =    Number of records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void add_llz_stats (INTERNAL_LLZ_HEADER *llz, const uint8_t *rec, int32_t count)
+{
+  LLZ_HEADER_STATS *stats = &llz->stats;
+  const LLZ_LAYOUT *layout = &llz->layout;
+  int32_t i, lat, lon, depth;
+
+
+  if (llz->stats_state == LLZ_STATS_UNKNOWN) return;
+
+  for (i = 0 ; i < count ; i++, rec += layout->record_size)
+    {
+      if (!llz_record_valid (layout, llz->swap, rec)) continue;
+
+      lat = get_llz_stats_field (rec + layout->lat_offset, llz->swap);
+      lon = get_llz_stats_field (rec + layout->lat_offset + 4, llz->swap);
+      depth = get_llz_stats_field (rec + layout->lat_offset + 8, llz->swap);
+
+      if (!stats->valid_count)
+        {
+          stats->min_lat = stats->max_lat = lat;
+          stats->min_lon = stats->max_lon = lon;
+          stats->min_depth = stats->max_depth = depth;
+        }
+      else
+        {
+          if (lat < stats->min_lat) stats->min_lat = lat;
+          if (lat > stats->max_lat) stats->max_lat = lat;
+          if (lon < stats->min_lon) stats->min_lon = lon;
+          if (lon > stats->max_lon) stats->max_lon = lon;
+          if (depth < stats->min_depth) stats->min_depth = depth;
+          if (depth > stats->max_depth) stats->max_depth = depth;
+        }
+
+      stats->valid_count++;
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    change_llz_stats
+
+ - Purpose:     Update the header statistics for records that have
+                just been overwritten.  If a valid record that was on
+                the edge of the extents changed position or was
+                invalidated the statistics become unknown.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - old_rec        =    The packed records before the change
+                - new_rec        =    The packed records after the change
+                - count          =    Number of records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void change_llz_stats (INTERNAL_LLZ_HEADER *llz, const uint8_t *old_rec, const uint8_t *new_rec, int32_t count)
+{
+  LLZ_HEADER_STATS *stats = &llz->stats;
+  const LLZ_LAYOUT *layout = &llz->layout;
+  int32_t i, lat, lon, depth;
+  uint8_t old_valid, new_valid;
+
+
+  if (llz->stats_state == LLZ_STATS_UNKNOWN) return;
+
+  for (i = 0 ; i < count ; i++, old_rec += layout->record_size, new_rec += layout->record_size)
+    {
+      old_valid = llz_record_valid (layout, llz->swap, old_rec);
+      new_valid = llz_record_valid (layout, llz->swap, new_rec);
+
+
+      /*  Nothing to do if the record is still valid and didn't move.  */
+
+      if (old_valid && new_valid && !memcmp (old_rec + layout->lat_offset, new_rec + layout->lat_offset, 12)) continue;
+
+      if (old_valid)
+        {
+          lat = get_llz_stats_field (old_rec + layout->lat_offset, llz->swap);
+          lon = get_llz_stats_field (old_rec + layout->lat_offset + 4, llz->swap);
+          depth = get_llz_stats_field (old_rec + layout->lat_offset + 8, llz->swap);
+
+          stats->valid_count--;
+
+
+          /*  With no valid records left there are no extents.  */
+
+          if (!stats->valid_count)
+            {
+              stats->min_lat = stats->max_lat = 0;
+              stats->min_lon = stats->max_lon = 0;
+              stats->min_depth = stats->max_depth = 0;
+            }
+          else if (lat == stats->min_lat || lat == stats->max_lat || lon == stats->min_lon || lon == stats->max_lon ||
+                   depth == stats->min_depth || depth == stats->max_depth)
+            {
+              llz->stats_state = LLZ_STATS_UNKNOWN;
+              return;
+            }
+        }
+
+      if (new_valid) add_llz_stats (llz, new_rec, 1);
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    merge_llz_stats
+
+ - Purpose:     Add one set of header statistics to another.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - stats          =    The statistics
+                - other          =    The statistics to add
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void merge_llz_stats (LLZ_HEADER_STATS *stats, const LLZ_HEADER_STATS *other)
+{
+  if (!other->valid_count) return;
+
+  if (!stats->valid_count)
+    {
+      *stats = *other;
+      return;
+    }
+
+  if (other->min_lat < stats->min_lat) stats->min_lat = other->min_lat;
+  if (other->max_lat > stats->max_lat) stats->max_lat = other->max_lat;
+  if (other->min_lon < stats->min_lon) stats->min_lon = other->min_lon;
+  if (other->max_lon > stats->max_lon) stats->max_lon = other->max_lon;
+  if (other->min_depth < stats->min_depth) stats->min_depth = other->min_depth;
+  if (other->max_depth > stats->max_depth) stats->max_depth = other->max_depth;
+
+  stats->valid_count += other->valid_count;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    scan_llz_stats
+
+ - Purpose:     Recompute the header statistics from every record in
+                the file.
+
+ - Date:        10/16/26
+
+ - Arguments:   llz            =    The internal llz header
+
+ - Returns:
+                - 0 on error (the statistics are then unknown)
+                - 1
+
+********************************************************************/
+
+uint8_t scan_llz_stats (INTERNAL_LLZ_HEADER *llz)
+{
+  int64_t n = llz->number_of_records64, start;
+  int32_t num, got, size = llz->layout.record_size;
+  uint8_t *buf;
+
+
+  if ((buf = (uint8_t *) malloc ((size_t) LLZ_STATS_CHUNK_RECORDS * size)) == NULL)
+    {
+      llz->stats_state = LLZ_STATS_UNKNOWN;
+      return (0);
+    }
+
+
+  /*  Make sure anything written through stdio is on disk before we go around it.  */
+
+  if (llz->write) fflush (llz->fp);
+
+  memset (&llz->stats, 0, sizeof (LLZ_HEADER_STATS));
+  llz->stats_state = LLZ_STATS_CURRENT;
+
+  for (start = 0 ; start < n ; start += num)
+    {
+      num = (int32_t) (n - start < LLZ_STATS_CHUNK_RECORDS ? n - start : LLZ_STATS_CHUNK_RECORDS);
+
+      if (llz->compression)
+        {
+          got = pread_llz_compressed (llz, start, num, buf);
+        }
+      else
+        {
+          got = (int32_t) (pread_llz_bytes (llz, start * size + LLZ_HEADER_SIZE, (size_t) num * size, buf) / size);
+        }
+
+      if (got != num)
+        {
+          llz->stats_state = LLZ_STATS_UNKNOWN;
+          break;
+        }
+
+      add_llz_stats (llz, buf, num);
+    }
+
+  free (buf);
+
+  return (llz->stats_state == LLZ_STATS_CURRENT);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    get_llz_stats
+
+ - Purpose:     Get the extents and number of valid records (records
+                with no LLZ_INVAL bits set) of an llz file without
+                reading the records.  The statistics are stored in the
+                header by this version of the library and are kept up to
+                date as records are appended or updated.  If the file
+                doesn't have them (it was written by an older version of
+                the library or an update couldn't be accounted for) they
+                are computed by reading every record, which is slow for
+                a large file.  The extents are zero if there are no valid
+                records.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - stats          =    The returned statistics
+
+ - Returns:
+                - 0 on error (or if the file is a compressed file
+                  that is still being written)
+                - 1
+
+********************************************************************/
+
+uint8_t get_llz_stats (int32_t hnd, LLZ_STATS *stats)
+{
+  INTERNAL_LLZ_HEADER *llz;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL) return (0);
+
+
+  /*  This is the only place that we'll read every record to get the statistics.  */
+
+  if (llz->stats_state == LLZ_STATS_UNKNOWN && ((llz->compression && llz->compression->write) || !scan_llz_stats (llz)))
+    return (0);
+
+  stats->valid_count = llz->stats.valid_count;
+  stats->min_lat = (double) llz->stats.min_lat / 10000000.0;
+  stats->max_lat = (double) llz->stats.max_lat / 10000000.0;
+  stats->min_lon = (double) llz->stats.min_lon / 10000000.0;
+  stats->max_lon = (double) llz->stats.max_lon / 10000000.0;
+  stats->min_depth = (float) llz->stats.min_depth / 10000.0f;
+  stats->max_depth = (float) llz->stats.max_depth / 10000.0f;
+
+  return (1);
+}
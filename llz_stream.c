@@ -0,0 +1,557 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+/*  Streaming sequential reads.  start_llz_stream starts a thread that reads the records ahead of the caller into
+    two large buffers with pread (so it never touches the handle's FILE position).  While the caller is decoding
+    the records in one buffer the thread is filling the other so the decoding overlaps the I/O.  The kernel is
+    also told (with posix_fadvise) that the file will be read sequentially so that it reads ahead aggressively.
+    Files opened with open_llz_mmap don't need the thread, the records are decoded straight from the mapping.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "llz_internal.h"
+
+#ifndef NVWIN3X
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+
+/*  Size, in bytes, of each of the two stream buffers.  */
+
+#define LLZ_STREAM_BYTES 4194304
+
+
+
+/********************************************************************/
+/*!
+
+ - Function:    fill_llz_stream
+
+ - Purpose:     Read the next chunk of packed records into a stream
+                buffer.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - stream         =    The stream
+                - buf            =    The buffer number
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void fill_llz_stream (const INTERNAL_LLZ_HEADER *llz, LLZ_STREAM *stream, int32_t buf)
+{
+  int64_t start = stream->next;
+  int32_t count, got;
+  size_t size;
+
+
+  count = stream->chunk_records;
+  if (count > stream->end - start) count = (int32_t) (stream->end - start);
+
+
+  /*  Compressed files are read so that each chunk ends on a block boundary.  */
+
+  if (llz->compression && count == stream->chunk_records) count -= (int32_t) ((start + count) % llz->block_records);
+
+  if (count <= 0)
+    {
+      got = 0;
+    }
+  else if (llz->compression)
+    {
+      got = pread_llz_compressed (llz, start, count, stream->buffer[buf]);
+    }
+  else
+    {
+      size = pread_llz_bytes (llz, start * llz->layout.record_size + LLZ_HEADER_SIZE, (size_t) count * llz->layout.record_size,
+                              stream->buffer[buf]);
+      got = (int32_t) (size / llz->layout.record_size);
+    }
+
+  stream->count[buf] = got;
+  stream->next = start + got;
+
+
+  /*  A short read ends the stream.  */
+
+  if (got < count) stream->end = stream->next;
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    prefetch_llz_stream
+
+ - Purpose:     The read ahead thread.  This keeps filling whichever
+                buffer the caller isn't using until it gets to the end of
+                the stream or is told to stop.
+
+ - Date:        10/16/26
+
+ - Arguments:   arg            =    The internal llz header
+
+ - Returns:     NULL
+
+********************************************************************/
+
+static void *prefetch_llz_stream (void *arg)
+{
+  INTERNAL_LLZ_HEADER *llz = (INTERNAL_LLZ_HEADER *) arg;
+  LLZ_STREAM *stream = llz->stream;
+  int32_t buf = 0;
+
+
+  while (1)
+    {
+      pthread_mutex_lock (&stream->mutex);
+
+      while (!stream->stop && stream->full[buf]) pthread_cond_wait (&stream->cond, &stream->mutex);
+
+      if (stream->stop)
+        {
+          pthread_mutex_unlock (&stream->mutex);
+          break;
+        }
+
+      pthread_mutex_unlock (&stream->mutex);
+
+
+      /*  The buffer is ours until we mark it full.  An empty buffer tells the caller that the stream is done.  */
+
+      fill_llz_stream (llz, stream, buf);
+
+      pthread_mutex_lock (&stream->mutex);
+
+      stream->full[buf] = 1;
+      pthread_cond_broadcast (&stream->cond);
+
+      pthread_mutex_unlock (&stream->mutex);
+
+      if (!stream->count[buf]) break;
+
+      buf ^= 1;
+    }
+
+  return (NULL);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    start_llz_stream
+
+ - Purpose:     Start streaming the records of an llz file from record
+                start to the end of the file.  Use read_llz_stream or
+                read_llz_stream_raw to get the records and
+                stop_llz_stream (or close_llz) when you're done.  The
+                records are read ahead of you in large chunks by a
+                separate thread so the I/O overlaps your processing.
+                This is the fastest way to scan a whole file.  Nothing
+                can be appended or updated while the handle is streaming
+                (other read functions can still be used except on
+                Windows where there's no pread).  Starting a new stream
+                stops the old one.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - start          =    The first record to stream
+
+ - Returns:
+                - 0 on error
+                - 1
+
+********************************************************************/
+
+uint8_t start_llz_stream (int32_t hnd, int64_t start)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  LLZ_STREAM *stream;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL || start < 0) return (0);
+
+  if (llz->stream) stop_llz_stream (hnd);
+
+
+  /*  Make sure anything appended through stdio is on disk before we go around it.  */
+
+  if (llz->write) fflush (llz->fp);
+
+  if ((stream = (LLZ_STREAM *) calloc (1, sizeof (LLZ_STREAM))) == NULL) return (0);
+
+  llz->stream = stream;
+
+  stream->next = start;
+  stream->end = llz->number_of_records64;
+  if (stream->next > stream->end) stream->next = stream->end;
+
+  stream->chunk_records = LLZ_STREAM_BYTES / llz->layout.record_size;
+
+
+  /*  Mapped files are decoded straight from the mapping.  */
+
+  if (llz->map)
+    {
+      if (stream->end > llz->map_records) stream->end = llz->map_records;
+
+#ifndef NVWIN3X
+      madvise (llz->map, llz->map_size, MADV_SEQUENTIAL);
+#endif
+
+      return (1);
+    }
+
+
+  /*  Compressed chunks are whole blocks.  */
+
+  if (llz->compression)
+    {
+      stream->chunk_records -= stream->chunk_records % llz->block_records;
+      if (stream->chunk_records < llz->block_records) stream->chunk_records = llz->block_records;
+    }
+
+  if ((stream->buffer[0] = (uint8_t *) malloc ((size_t) stream->chunk_records * llz->layout.record_size)) == NULL ||
+      (stream->buffer[1] = (uint8_t *) malloc ((size_t) stream->chunk_records * llz->layout.record_size)) == NULL)
+    {
+      stop_llz_stream (hnd);
+      return (0);
+    }
+
+#ifndef NVWIN3X
+  posix_fadvise (fileno (llz->fp), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  pthread_mutex_init (&stream->mutex, NULL);
+  pthread_cond_init (&stream->cond, NULL);
+  stream->sync = 1;
+
+  if (pthread_create (&stream->thread, NULL, prefetch_llz_stream, llz))
+    {
+      stop_llz_stream (hnd);
+      return (0);
+    }
+
+  stream->running = 1;
+
+  return (1);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    next_llz_stream
+
+ - Purpose:     Get a view of the next unused records in the stream.
+                When everything in the current buffer has been used it
+                is handed back to the read ahead thread and we wait for
+                the other buffer.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - rec            =    The returned pointer to the next
+                                      packed record
+
+ - Returns:
+                - The number of records available at rec
+                - 0 at the end of the stream
+
+********************************************************************/
+
+static int32_t next_llz_stream (INTERNAL_LLZ_HEADER *llz, const uint8_t **rec)
+{
+  LLZ_STREAM *stream = llz->stream;
+  int32_t cur = stream->current, count;
+
+
+  /*  Mapped file.  */
+
+  if (llz->map)
+    {
+      count = stream->chunk_records;
+      if (count > stream->end - stream->next) count = (int32_t) (stream->end - stream->next);
+
+      *rec = llz->map + LLZ_HEADER_SIZE + (size_t) stream->next * llz->layout.record_size;
+
+      return (count);
+    }
+
+
+  if (stream->held && stream->used < stream->count[cur])
+    {
+      *rec = stream->buffer[cur] + (size_t) stream->used * llz->layout.record_size;
+
+      return (stream->count[cur] - stream->used);
+    }
+
+
+  pthread_mutex_lock (&stream->mutex);
+
+
+  /*  Give back the buffer that we've finished with (unless it's the empty one that ends the stream).  */
+
+  if (stream->held && stream->count[cur])
+    {
+      stream->full[cur] = 0;
+      stream->held = 0;
+      pthread_cond_broadcast (&stream->cond);
+
+      cur = stream->current ^= 1;
+      stream->used = 0;
+    }
+
+  while (!stream->full[cur]) pthread_cond_wait (&stream->cond, &stream->mutex);
+
+  stream->held = 1;
+
+  pthread_mutex_unlock (&stream->mutex);
+
+  *rec = stream->buffer[cur];
+
+  return (stream->count[cur]);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    use_llz_stream
+
+ - Purpose:     Mark records from next_llz_stream as used.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - llz            =    The internal llz header
+                - count          =    The number of records used
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void use_llz_stream (INTERNAL_LLZ_HEADER *llz, int32_t count)
+{
+  if (llz->map)
+    {
+      llz->stream->next += count;
+    }
+  else
+    {
+      llz->stream->used += count;
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_stream
+
+ - Purpose:     Get the next count records from a stream started with
+                start_llz_stream.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - data           =    The returned llz records
+                - count          =    The maximum number of records to
+                                      return
+
+ - Returns:
+                - The number of records returned (this will only be less
+                  than count at the end of the stream)
+                - 0 at the end of the stream or on error
+
+********************************************************************/
+
+int32_t read_llz_stream (int32_t hnd, LLZ_REC *data, int32_t count)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  const uint8_t *rec;
+  int32_t done, num;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL || llz->stream == NULL || count <= 0) return (0);
+
+  for (done = 0 ; done < count ; done += num)
+    {
+      if ((num = next_llz_stream (llz, &rec)) == 0) break;
+
+      if (num > count - done) num = count - done;
+
+      decode_llz_records (&llz->layout, llz->swap, rec, num, &data[done]);
+
+      use_llz_stream (llz, num);
+    }
+
+  return (done);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    read_llz_stream_raw
+
+ - Purpose:     Get a zero-copy view of the next block of packed records
+                from a stream started with start_llz_stream.  This is
+                usually a few megabytes worth of records.  Use the
+                llz_raw_* inline functions in llz.h to get the fields
+                that you need.  The view is only valid until the next
+                read_llz_stream, read_llz_stream_raw, stop_llz_stream,
+                or close_llz call on this handle.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - hnd            =    The file handle
+                - raw            =    The returned view of the packed
+                                      records
+
+ - Returns:
+                - The number of records available in raw
+                - 0 at the end of the stream or on error
+
+********************************************************************/
+
+int32_t read_llz_stream_raw (int32_t hnd, LLZ_RAW *raw)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  const uint8_t *rec;
+  int32_t count;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL || llz->stream == NULL) return (0);
+
+  if ((count = next_llz_stream (llz, &rec)) == 0) return (0);
+
+  use_llz_stream (llz, count);
+
+
+  raw->data = rec;
+  raw->count = count;
+  raw->record_size = llz->layout.record_size;
+  raw->time_offset = llz->layout.time_offset;
+  raw->uncertainty_offset = llz->layout.uncertainty_offset;
+  raw->lat_offset = llz->layout.lat_offset;
+  raw->lon_offset = llz->layout.lat_offset + sizeof (int32_t);
+  raw->depth_offset = llz->layout.lat_offset + 2 * sizeof (int32_t);
+  raw->stat_offset = llz->layout.stat_offset;
+  raw->stat_size = llz->layout.stat_size;
+  raw->swap = llz->swap;
+
+  return (count);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    stop_llz_stream
+
+ - Purpose:     Stop a stream started with start_llz_stream and free its
+                buffers.  close_llz does this for you.
+
+ - Date:        10/16/26
+
+ - Arguments:   hnd            =    The file handle
+
+ - Returns:     N/A
+
+********************************************************************/
+
+void stop_llz_stream (int32_t hnd)
+{
+  INTERNAL_LLZ_HEADER *llz;
+  LLZ_STREAM *stream;
+
+
+  if ((llz = get_llz_handle (hnd)) == NULL || (stream = llz->stream) == NULL) return;
+
+  if (stream->running)
+    {
+      pthread_mutex_lock (&stream->mutex);
+
+      stream->stop = 1;
+      pthread_cond_broadcast (&stream->cond);
+
+      pthread_mutex_unlock (&stream->mutex);
+
+      pthread_join (stream->thread, NULL);
+    }
+
+  if (stream->sync)
+    {
+      pthread_mutex_destroy (&stream->mutex);
+      pthread_cond_destroy (&stream->cond);
+    }
+
+
+  /*  Put the kernel read ahead back the way it was.  */
+
+#ifndef NVWIN3X
+  if (llz->map)
+    {
+      madvise (llz->map, llz->map_size, MADV_NORMAL);
+    }
+  else
+    {
+      posix_fadvise (fileno (llz->fp), 0, 0, POSIX_FADV_NORMAL);
+    }
+#endif
+
+  if (stream->buffer[0]) free (stream->buffer[0]);
+  if (stream->buffer[1]) free (stream->buffer[1]);
+
+  free (stream);
+
+  llz->stream = NULL;
+}
@@ -38,7 +38,7 @@
 
 #ifndef LLZ_VERSION
 
-#define     LLZ_VERSION "PFM Software - llz library V4.03 - 07/21/2014"
+#define     LLZ_VERSION "PFM Software - llz library V4.28 - 10/16/2026"
 
 #endif
 
@@ -165,4 +165,219 @@
 
     Replaced nvtypes.h data types with stdint.h data types (e.g. uint32_t instead of NV_U_INT32).
 
+
+    Version 4.04
+    10/16/26
+
+    Added read_llz_range to read and decode blocks of consecutive records with a single fread per block.
+    The on-disk record layout is now computed once when the file is opened and read_llz reads each record
+    with a single fread.  Fixed byte swapping of the 16 bit status in swapped version 4.00 and later files.
+
+
+    Version 4.05
+    10/16/26
+
+    Added append_llz_batch to pack records into a staging buffer and write them in large blocks.  append_llz
+    and update_llz now pack each record and write it with a single fwrite.  update_llz now clears at_end so
+    that a following append_llz seeks back to the end of the file.
+
+
+    Version 4.06
+    10/16/26
+
+    Added open_llz_mmap to open a file read only and memory map the records.  read_llz and read_llz_range
+    decode directly from the mapping.  open_llz no longer leaks the handle when asked to open a non-llz file.
+
+
+    Version 4.07
+    10/16/26
+
+    Added read_llz_raw and the llz_raw_* inline field decoders so that callers that only need some of the
+    fields (e.g. status or depth) don't have to pay to decode every field of every record.
+
+
+    Version 4.08
+    10/16/26
+
+    Added llz_kernels.c with SSE2 and AVX2 record decode kernels (selected at run time) and a scalar
+    fallback.  All reads now go through these kernels.  Latitude and longitude are now scaled in double
+    precision instead of long double so that every kernel returns identical results.  This can change the
+    last bit of a decoded position in rare cases (it's now the correctly rounded value).
+
+
+    Version 4.09
+    10/16/26
+
+    Added SSE2 and AVX2 record encode kernels for append_llz, append_llz_batch, and update_llz.  Any group
+    of values that is too close to a half for the vector rounding to be certain of matching NINT is encoded
+    with the scalar (NINT) code so the output is always bit for bit identical.
+
+
+    Version 4.10
+    10/16/26
+
+    Added read_llz_columns to read records into separate lat, lon, depth, uncertainty, status, and time
+    arrays (any of which may be NULL to skip that field).
+
+
+    Version 4.11
+    10/16/26
+
+    Made the library thread safe for concurrent use of different handles.  Handle allocation and release in
+    create_llz, open_llz, and close_llz are now serialized with a mutex.  Replaced strtok and asctime/localtime
+    with reentrant code and the run time kernel selection now uses pthread_once.  Removed the "first" flag
+    (which was never set so the initialization never ran anyway).  create_llz and open_llz no longer leave
+    the handle allocated when the file can't be opened.
+
+
+    Version 4.12
+    10/16/26
+
+    Added pread_llz_range, a stateless positional read that lets many threads read different parts of the
+    same file at the same time.
+
+
+    Version 4.13
+    10/16/26
+
+    Replaced the fixed array of MAX_LLZ_FILES handles with a handle table that grows as needed (up to
+    LLZ_MAX_HANDLES).  create_llz and open_llz now return -1 when no handle is available instead of calling
+    exit.  All of the handle based functions now check for a bad or closed handle and return an error.
+
+
+    Version 4.14
+    10/16/26
+
+    Added 64 bit record counts and record numbers.  [NUMBER OF RECORDS] is now written and read as a 64 bit
+    value and returned by the new get_llz_record_count64 (LLZ_HEADER is unchanged so that programs built
+    against older versions of the library still work, its number_of_records is set to INT32_MAX for files
+    with more records than that).  Added read_llz64, update_llz64, and ftell_llz64.  The start record for
+    read_llz_range, read_llz_columns, read_llz_raw, and pread_llz_range is now 64 bit.
+
+
+    Version 4.15
+    10/16/26
+
+    Replaced the ngets/strstr header parser with a single pass tokenizer that reads the 16384 byte header
+    with one read and dispatches on the bracketed key.  Values that are too long for the LLZ_HEADER fields
+    are now truncated instead of overflowing them.  Fixed [DEPTH UNITS], which was always read as METERS.
+
+
+    Version 4.16
+    10/16/26
+
+    Added probe_llz to get the header and basic file information (version, endianness, record size, and 64
+    bit record count) with a single read.  It doesn't use a handle and never opens the file for writing.
+
+
+    Version 4.17
+    10/16/26
+
+    write_llz_header now builds the entire zero padded header block in memory and writes it with a single
+    fwrite instead of a couple of dozen fprintf calls followed by about 15,000 one byte fwrite calls.  The
+    header contents are unchanged.
+
+
+    Version 4.18
+    10/16/26
+
+    Added update_llz_status to change only the status of a list of records.  The updates are sorted and
+    coalesced and only the 2 or 4 byte status field is written (nearby updates are done with a single read
+    and write of the records they span).
+
+
+    Version 4.19
+    10/16/26
+
+    Added update_llz_batch to update scattered records.  The records are sorted by file offset and runs of
+    consecutive records are written with a single seek and write so the file is updated in one forward pass.
+
+
+    Version 4.20
+    10/16/26
+
+    Added an optional bounding box index.  create_llz_index writes a <llz file>.idx sidecar file with the
+    minimum and maximum latitude, longitude, and depth of each block of records and read_llz_bbox uses it to
+    skip blocks that can't contain any points in the requested area.  Closing a handle that changed the llz
+    file removes the index.  Moved INTERNAL_LLZ_HEADER into llz_internal.h so that it can be shared by the
+    new llz_index.c.
+
+
+    Version 4.21
+    10/16/26
+
+    Added sort_llz to write a copy of an llz file with the records sorted along a Hilbert or Z-order
+    (Morton) curve over latitude and longitude.  The header and the packed records are copied exactly.  The
+    sort is done out of core (sorted runs in temporary files that are then merged) so files larger than
+    memory can be sorted.  Added the tools/llz_sort command line program that calls it.
+
+
+    Version 4.22
+    10/16/26
+
+    Added read_llz_time_range to retrieve the records in a time window.  The index now also holds the
+    minimum and maximum time of each block and whether the times in the file never decrease.  Blocks
+    outside of the time window are skipped and, for files in time order, the first block is found with a
+    binary search.  Indexes written by 4.20 and 4.21 are ignored (rebuild them with create_llz_index).
+
+
+    Version 4.23
+    10/16/26
+
+    Added create_llz_compressed to write block compressed llz files (see llz_compress.c).  The records are
+    compressed in independent blocks of 4096 records.  In each block the time, uncertainty, latitude,
+    longitude, and depth columns are stored as bit packed deltas, bit packed values, or variable length
+    integer deltas (whichever is smallest) and the status is run length encoded or stored as bit packed
+    indexes into a table of values.  A table of block offsets at the end of the file keeps read_llz random
+    access working.  Compressed files are read only after they are closed.  The header has the new
+    [COMPRESSION], [BLOCK RECORDS], [BLOCK TABLE], and [COMPRESSED RECORDS] keys and [NUMBER OF RECORDS] is 0
+    so older versions of the library see an empty file.  Files with [COMPRESSION] = DELTA (variable length
+    integer deltas only) are still read.
+
+
+    Version 4.24
+    10/16/26
+
+    Added start_llz_stream, read_llz_stream, read_llz_stream_raw, and stop_llz_stream for fast sequential
+    scans.  A read ahead thread fills two large buffers with pread while the caller decodes the other one
+    and the kernel is told the file will be read sequentially.  read_llz now serves consecutive records
+    (e.g. LLZ_NEXT_RECORD) from a small read ahead buffer instead of seeking for every record.
+
+
+    Version 4.25
+    10/16/26
+
+    Added read_llz_async to scan many llz files at once with many block reads in flight.  Reads are
+    submitted through io_uring on Linux when the kernel supports it and done by a small pool of pread
+    threads otherwise.  Decoded batches are handed to a callback in the calling thread.
+
+
+    Version 4.26
+    10/16/26
+
+    Added merge_llz to concatenate llz files using several threads.  Each input file's place in the
+    output file is computed from the record counts up front and chunks of records are written straight
+    to it with pwrite.  Records are only converted (exactly, as scaled integers) when the input layout or
+    byte order differs from the output.  Added the tools/llz_merge command line program that calls it.
+
+
+    Version 4.27
+    10/16/26
+
+    Added reduce_llz, a parallel map/reduce over a range of records.  Each thread decodes its own part
+    of the range with pread_llz_range and reduces it into its own state and the states are merged in
+    record order.  Built in reducers for the bounding box, depth statistics (min, max, mean, variance),
+    status counts, and depth histograms are included.
+
+
+    Version 4.28
+    10/16/26
+
+    The header now has [VALID COUNT], [MIN LAT], [MAX LAT], [MIN LON], [MAX LON], [MIN DEPTH], and
+    [MAX DEPTH] keys for the valid records and get_llz_stats returns them without reading the file.
+    They're kept up to date by append_llz, append_llz_batch, update_llz, update_llz_batch, and
+    update_llz_status (they're dropped from the header, rather than rescanning the file, when a valid
+    record on the edge of the extents is changed or invalidated or when an updated record wasn't just
+    read with read_llz) and merge_llz combines the statistics of its input files.
+
 </pre>*/
@@ -0,0 +1,377 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+/*  Bit exactness test for the record encode kernels in llz_kernels.c.  Every vector encoder that this CPU supports
+    is compared, byte for byte, with the scalar NINT encoder for every record layout, byte swapped and not, with
+    the source arrays both strided (an array of LLZ_REC) and dense.  The values include random values, exact halves,
+    values one ulp either side of a half, NaN, and values that are out of range for a 32 bit integer once they're
+    scaled.  The kernels are declared in llz_internal.h.  Build and run it from this directory with something
+    like:
+
+        cc -O2 -I.. -I<nvutility include dir> -c ../llz_kernels.c
+        cc -O2 -I.. -I<nvutility include dir> -o llz_kernels_test llz_kernels_test.c llz_kernels.o \
+           -L<nvutility lib dir> -lnvutility -lpthread -lm
+        ./llz_kernels_test
+
+    It prints each mismatch and exits with a non-zero status if there are any.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "llz_internal.h"
+
+
+/*  Number of records encoded for each layout.  This is odd so that the leftover records after the last full
+    vector are tested too.  */
+
+#define TEST_RECORDS 400001
+
+
+/********************************************************************/
+/*!
+
+ - Function:    test_random
+
+ - Purpose:     Return a uniform random number from 0.0 to 1.0.
+
+ - Date:        10/16/26
+
+ - Arguments:   N/A
+
+ - Returns:     The random number
+
+********************************************************************/
+
+static double test_random ()
+{
+  return ((double) rand () / (double) RAND_MAX);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    test_half
+
+ - Purpose:     Return a value that is exactly half way between two
+                scaled integers (as near as a double can get).
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - range          =    Range of the scaled integer
+                - scale          =    The scale factor
+
+ - Returns:     The value
+
+********************************************************************/
+
+static double test_half (int32_t range, double scale)
+{
+  return (((double) (rand () % range) - (double) (range / 2) + 0.5) / scale);
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    make_test_records
+
+ - Purpose:     Fill an array of LLZ_REC with values that are hard to
+                round.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - rec            =    The records
+                - count          =    Number of records
+
+ - Returns:     N/A
+
+********************************************************************/
+
+static void make_test_records (LLZ_REC *rec, int32_t count)
+{
+  double half;
+  int32_t i;
+
+
+  for (i = 0 ; i < count ; i++)
+    {
+      rec[i].tv_sec = rand ();
+      rec[i].tv_nsec = rand ();
+      rec[i].status = (uint32_t) rand ();
+
+      switch (rand () % 5)
+        {
+          /*  Ordinary values.  */
+
+        case 0:
+          rec[i].xy.lat = (test_random () - 0.5) * 180.0;
+          rec[i].xy.lon = (test_random () - 0.5) * 360.0;
+          rec[i].depth = (float) ((test_random () - 0.1) * 11000.0);
+          rec[i].uncertainty = (float) (test_random () * 10.0);
+          break;
+
+
+          /*  Exact halves.  */
+
+        case 1:
+          rec[i].xy.lat = test_half (1800000000, 10000000.0);
+          rec[i].xy.lon = -rec[i].xy.lat;
+          rec[i].depth = (float) test_half (2000000, 10000.0);
+          rec[i].uncertainty = (float) test_half (2000, 10000.0);
+          break;
+
+
+          /*  One ulp above a half.  */
+
+        case 2:
+          half = test_half (1800000000, 10000000.0);
+          rec[i].xy.lat = nextafter (half, 1.0e9);
+          rec[i].xy.lon = nextafter (-half, 1.0e9);
+          rec[i].depth = nextafterf ((float) test_half (2000000, 10000.0), 1.0e9f);
+          rec[i].uncertainty = nextafterf ((float) test_half (2000, 10000.0), 1.0e9f);
+          break;
+
+
+          /*  One ulp below a half.  */
+
+        case 3:
+          half = test_half (1800000000, 10000000.0);
+          rec[i].xy.lat = nextafter (half, -1.0e9);
+          rec[i].xy.lon = nextafter (-half, -1.0e9);
+          rec[i].depth = nextafterf ((float) test_half (2000000, 10000.0), -1.0e9f);
+          rec[i].uncertainty = nextafterf ((float) test_half (2000, 10000.0), -1.0e9f);
+          break;
+
+
+          /*  NaN and values that don't fit in 32 bits once they're scaled (mixed with ordinary values so that
+              some vectors have only one bad value).  */
+
+        default:
+          rec[i].xy.lat = (rand () % 2) ? 214.7483647 : (test_random () - 0.5) * 180.0;
+          rec[i].xy.lon = (rand () % 2) ? NAN : -300.0;
+          rec[i].depth = (rand () % 2) ? 1.0e6f : -0.00005f;
+          rec[i].uncertainty = (rand () % 2) ? NAN : 3.0e5f;
+          break;
+        }
+    }
+}
+
+
+/********************************************************************/
+/*!
+
+ - Function:    compare_encoders
+
+ - Purpose:     Encode with the scalar encoder and every vector encoder
+                that this CPU supports and compare the results.
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - layout         =    The record layout
+                - swap           =    Set to byte swap the records
+                - src            =    Source arrays
+                - count          =    Number of records
+                - name           =    Description of the test
+
+ - Returns:     The number of mismatches
+
+********************************************************************/
+
+static int32_t compare_encoders (const LLZ_LAYOUT *layout, uint8_t swap, const LLZ_COLUMNS *src, int32_t count, const char *name)
+{
+  size_t size = (size_t) count * layout->record_size;
+  uint8_t *expected, *buf;
+  int32_t fails = 0;
+
+
+  expected = (uint8_t *) calloc (size, 1);
+  buf = (uint8_t *) calloc (size, 1);
+
+  if (expected == NULL || buf == NULL)
+    {
+      fprintf (stderr, "Out of memory\n");
+      exit (-1);
+    }
+
+  encode_llz_scalar (layout, swap, src, 0, count, expected);
+
+#ifdef LLZ_X86_KERNELS
+
+  __builtin_cpu_init ();
+
+  if (__builtin_cpu_supports ("sse2"))
+    {
+      memset (buf, 0, size);
+      encode_llz_sse2 (layout, swap, src, 0, count, buf);
+
+      if (memcmp (expected, buf, size))
+        {
+          printf ("SSE2 encoder doesn't match NINT: %s\n", name);
+          fails++;
+        }
+    }
+
+  if (__builtin_cpu_supports ("avx2"))
+    {
+      memset (buf, 0, size);
+      encode_llz_avx2 (layout, swap, src, 0, count, buf);
+
+      if (memcmp (expected, buf, size))
+        {
+          printf ("AVX2 encoder doesn't match NINT: %s\n", name);
+          fails++;
+        }
+    }
+
+#endif
+
+  free (expected);
+  free (buf);
+
+  return (fails);
+}
+
+
+int32_t main ()
+{
+  LLZ_LAYOUT layout;
+  LLZ_COLUMNS src;
+  LLZ_REC *rec;
+  double *lat, *lon;
+  float *depth, *uncertainty;
+  int32_t i, version, time_flag, uncertainty_flag, offset, fails = 0;
+  uint8_t swap;
+  char name[128];
+
+
+  srand (6);
+
+  rec = (LLZ_REC *) malloc ((size_t) TEST_RECORDS * sizeof (LLZ_REC));
+  lat = (double *) malloc ((size_t) TEST_RECORDS * sizeof (double));
+  lon = (double *) malloc ((size_t) TEST_RECORDS * sizeof (double));
+  depth = (float *) malloc ((size_t) TEST_RECORDS * sizeof (float));
+  uncertainty = (float *) malloc ((size_t) TEST_RECORDS * sizeof (float));
+
+  if (rec == NULL || lat == NULL || lon == NULL || depth == NULL || uncertainty == NULL)
+    {
+      fprintf (stderr, "Out of memory\n");
+      exit (-1);
+    }
+
+
+  /*  Version 1.00 (32 bit status, no time or uncertainty), 2.xx/3.xx (32 bit status), and 4.00+ (16 bit status)
+      layouts with and without time and uncertainty.  */
+
+  for (version = 1 ; version <= 4 ; version++)
+    {
+      if (version == 2) continue;
+
+      for (time_flag = 0 ; time_flag < 2 ; time_flag++)
+        {
+          for (uncertainty_flag = 0 ; uncertainty_flag < 2 ; uncertainty_flag++)
+            {
+              if (version == 1 && (time_flag || uncertainty_flag)) continue;
+
+              offset = 0;
+              layout.time_offset = time_flag ? offset : -1;
+              offset += time_flag ? 8 : 0;
+              layout.uncertainty_offset = uncertainty_flag ? offset : -1;
+              offset += uncertainty_flag ? 4 : 0;
+              layout.lat_offset = offset;
+              offset += 12;
+              layout.stat_offset = offset;
+              layout.stat_size = (version >= 4) ? 2 : 4;
+              layout.record_size = offset + layout.stat_size;
+
+              make_test_records (rec, TEST_RECORDS);
+
+              for (i = 0 ; i < TEST_RECORDS ; i++)
+                {
+                  lat[i] = rec[i].xy.lat;
+                  lon[i] = rec[i].xy.lon;
+                  depth[i] = rec[i].depth;
+                  uncertainty[i] = rec[i].uncertainty;
+                }
+
+              for (swap = 0 ; swap < 2 ; swap++)
+                {
+                  /*  Strided (array of LLZ_REC).  */
+
+                  src.tv_sec = &rec->tv_sec;
+                  src.tv_nsec = &rec->tv_nsec;
+                  src.uncertainty = &rec->uncertainty;
+                  src.lat = &rec->xy.lat;
+                  src.lon = &rec->xy.lon;
+                  src.depth = &rec->depth;
+                  src.status = &rec->status;
+                  src.stride = sizeof (LLZ_REC);
+
+                  sprintf (name, "version %d, time %d, uncertainty %d, swap %d, strided", version, time_flag, uncertainty_flag, swap);
+                  fails += compare_encoders (&layout, swap, &src, TEST_RECORDS, name);
+
+
+                  /*  Dense (structure of arrays).  */
+
+                  memset (&src, 0, sizeof (LLZ_COLUMNS));
+                  src.uncertainty = uncertainty;
+                  src.lat = lat;
+                  src.lon = lon;
+                  src.depth = depth;
+
+                  sprintf (name, "version %d, time %d, uncertainty %d, swap %d, dense", version, time_flag, uncertainty_flag, swap);
+                  fails += compare_encoders (&layout, swap, &src, TEST_RECORDS, name);
+                }
+            }
+        }
+    }
+
+  free (rec);
+  free (lat);
+  free (lon);
+  free (depth);
+  free (uncertainty);
+
+  printf ("%d mismatches\n", fails);
+
+  return (fails != 0);
+}
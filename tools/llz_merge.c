@@ -0,0 +1,153 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  llz_merge - concatenate llz files into a new llz file using several threads (see merge_llz in llz_merge.c).
+    Build it from this directory with something like:
+
+        cc -O2 -I.. -I<nvutility include dir> -o llz_merge llz_merge.c ../llz*.c -L<nvutility lib dir> -lnvutility \
+           -lpthread -lm
+
+    Usage: llz_merge [-t <threads>] -o <output llz file> <input llz file> [<input llz file> ...]
+
+    The records are written in the order the input files are given and the output file gets the header of the
+    first input file.  The exit status is 0 on success, 1 if the files couldn't be merged, and 2 for bad
+    arguments.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "llz.h"
+
+
+/********************************************************************/
+/*!
+
+ - Function:    usage
+
+ - Purpose:     Print the command line usage and exit.
+
+ - Date:        10/16/26
+
+ - Arguments:   N/A
+
+ - Returns:     N/A (exits with status 2)
+
+********************************************************************/
+
+static void usage ()
+{
+  fprintf (stderr, "\nUsage: llz_merge [-t <threads>] -o <output llz file> <input llz file> [<input llz file> ...]\n\n");
+  fprintf (stderr, "Where:\n\n");
+  fprintf (stderr, "\t-t  =  number of copy threads (default 8)\n");
+  fprintf (stderr, "\t-o  =  the merged llz file (must not be one of the input files)\n\n");
+  fflush (stderr);
+
+  exit (2);
+}
+
+
+int32_t main (int32_t argc, char **argv)
+{
+  struct stat in_stat, out_stat;
+  int32_t i, count = 0, threads = 0;
+  const char **in_paths;
+  char *out_path = NULL, *end;
+
+
+  if ((in_paths = (const char **) malloc (argc * sizeof (char *))) == NULL)
+    {
+      fprintf (stderr, "Out of memory\n");
+      exit (1);
+    }
+
+  for (i = 1 ; i < argc ; i++)
+    {
+      if (!strcmp (argv[i], "-t"))
+        {
+          if (++i == argc) usage ();
+
+          threads = (int32_t) strtol (argv[i], &end, 10);
+
+          if (*end || threads <= 0) usage ();
+        }
+      else if (!strcmp (argv[i], "-o"))
+        {
+          if (++i == argc || out_path) usage ();
+
+          out_path = argv[i];
+        }
+      else if (argv[i][0] == '-')
+        {
+          usage ();
+        }
+      else
+        {
+          in_paths[count++] = argv[i];
+        }
+    }
+
+  if (out_path == NULL || !count) usage ();
+
+
+  /*  merge_llz only compares the names so catch different names for the output file here.  */
+
+  if (!stat (out_path, &out_stat) && out_stat.st_ino)
+    {
+      for (i = 0 ; i < count ; i++)
+        {
+          if (!stat (in_paths[i], &in_stat) && in_stat.st_dev == out_stat.st_dev && in_stat.st_ino == out_stat.st_ino)
+            {
+              fprintf (stderr, "llz_merge: %s and %s are the same file\n", in_paths[i], out_path);
+              exit (2);
+            }
+        }
+    }
+
+  if (!merge_llz (in_paths, count, out_path, threads))
+    {
+      fprintf (stderr, "llz_merge: unable to merge %d files into %s\n", count, out_path);
+      fprintf (stderr, "An input file can't be read or the output file can't be written\n");
+      exit (1);
+    }
+
+  free (in_paths);
+
+  return (0);
+}
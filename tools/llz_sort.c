@@ -0,0 +1,128 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  llz_sort - write a copy of an llz file with the records sorted along a Hilbert or Z-order (Morton) curve over
+    latitude and longitude (see sort_llz in llz_sort.c).  Build it from this directory with something like:
+
+        cc -O2 -I.. -I<nvutility include dir> -o llz_sort llz_sort.c ../llz*.c -L<nvutility lib dir> -lnvutility \
+           -lpthread -lm
+
+    Usage: llz_sort [-m] <input llz file> <output llz file>
+
+    The records are sorted along a Hilbert curve unless -m (Morton order) is given.  Temporary files named
+    <output llz file>.sort<N> are made next to the output file while it runs.  The exit status is 0 on success, 1
+    if the file couldn't be sorted, and 2 for bad arguments.  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "llz.h"
+
+
+/********************************************************************/
+/*!
+
+ - Function:    usage
+
+ - Purpose:     Print the command line usage and exit.
+
+ - Date:        10/16/26
+
+ - Arguments:   N/A
+
+ - Returns:     N/A (exits with status 2)
+
+********************************************************************/
+
+static void usage ()
+{
+  fprintf (stderr, "\nUsage: llz_sort [-m] <input llz file> <output llz file>\n\n");
+  fprintf (stderr, "Where:\n\n");
+  fprintf (stderr, "\t-m  =  sort along a Z-order (Morton) curve instead of a Hilbert curve\n\n");
+  fflush (stderr);
+
+  exit (2);
+}
+
+
+int32_t main (int32_t argc, char **argv)
+{
+  struct stat in_stat, out_stat;
+  int32_t i, paths = 0, order = LLZ_HILBERT_ORDER;
+  char *path[2] = {NULL, NULL};
+
+
+  for (i = 1 ; i < argc ; i++)
+    {
+      if (!strcmp (argv[i], "-m"))
+        {
+          order = LLZ_MORTON_ORDER;
+        }
+      else if (argv[i][0] == '-' || paths == 2)
+        {
+          usage ();
+        }
+      else
+        {
+          path[paths++] = argv[i];
+        }
+    }
+
+  if (paths != 2) usage ();
+
+
+  /*  sort_llz only compares the names so catch different names for the same file here.  */
+
+  if (!stat (path[0], &in_stat) && !stat (path[1], &out_stat) && in_stat.st_ino && in_stat.st_dev == out_stat.st_dev &&
+      in_stat.st_ino == out_stat.st_ino)
+    {
+      fprintf (stderr, "llz_sort: %s and %s are the same file\n", path[0], path[1]);
+      exit (2);
+    }
+
+  if (!sort_llz (path[0], path[1], order))
+    {
+      fprintf (stderr, "llz_sort: unable to sort %s into %s\n", path[0], path[1]);
+      fprintf (stderr, "The input file can't be read or is compressed or the output file can't be written\n");
+      exit (1);
+    }
+
+  return (0);
+}